@@ -1,6 +1,7 @@
 #include "ApplicationBase.h"
 #include "ShaderProgram.h"
 #include "Model.h"
+#include "FileLocator.h"
 #include "Texture.h"
 #include "FrameBuffer.h"
 
@@ -16,6 +17,8 @@ public:
 	{
 		setDisplayStatusHint();
 
+		CFileLocator::getInstance()->addFileSearchPath("../../resource");
+
 		m_pGenGbufferShaderProgram = std::make_unique<CShaderProgram>();
 		m_pGenGbufferShaderProgram->addShader("shaders/generate_gbuffer_vs.glsl", EShaderType::VERTEX_SHADER);
 		m_pGenGbufferShaderProgram->addShader("shaders/generate_gbuffer_fs.glsl", EShaderType::FRAGMENT_SHADER);
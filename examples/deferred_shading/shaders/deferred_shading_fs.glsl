@@ -5,7 +5,7 @@ uniform sampler2D uNormalTex;
 uniform sampler2D uDiffuseTex;
 uniform sampler2D uSpecularTex;
 
-uniform vec3 uViewPos;
+#include "frame_uniforms.glsl"
 
 layout(location = 0) in vec2 _inTexCoord;
 
@@ -1,12 +1,8 @@
 #version 460 core
 
-uniform mat4 uModelMatrix;
-uniform mat4 uViewMatrix;
-uniform mat4 uProjectionMatrix;
-
-layout(location = 0) in vec3 _inVertexPosition;
-layout(location = 1) in vec3 _inVertexNormal;
-layout(location = 2) in vec2 _inVertexTexCoord;
+#include "instance_transforms.glsl"
+#include "frame_uniforms.glsl"
+#include "vertex_attributes.glsl"
 
 layout(location = 0) out vec3 _outPositionW;
 layout(location = 1) out vec3 _outNormalW;
@@ -14,8 +10,9 @@ layout(location = 2) out vec2 _outTexCoord;
 
 void main()
 {
-	_outPositionW = vec3(uModelMatrix * vec4(_inVertexPosition, 1.0));
-	_outNormalW = mat3(transpose(inverse(uModelMatrix))) * _inVertexNormal;
+	mat4 ModelMatrix = fetchModelMatrix();
+	_outPositionW = vec3(ModelMatrix * fetchVertexPosition());
+	_outNormalW = mat3(transpose(inverse(ModelMatrix))) * fetchVertexNormal().xyz;
 	_outTexCoord = _inVertexTexCoord;
 	gl_Position = uProjectionMatrix * uViewMatrix * vec4(_outPositionW, 1.0);
 }
\ No newline at end of file
@@ -25,6 +25,22 @@
 
 #define USING_WAVELET_OIT
 
+#define USING_TEXTURE_STREAMING
+
+#define USING_PACKED_VERTEX
+
+#define USING_MERGED_MESH_BUFFERS
+
+#define USING_MESH_LOD
+
+#define USING_PRE_SKINNING
+
+#define USING_COMMAND_QUEUE
+
+#define USING_INSTANCE_BATCHING
+
+#define USING_FRUSTUM_CULLING
+
 #ifdef USING_ALL_METHODS
 #define USING_MOMENT_BASED_OIT
 #define USING_WEIGHTED_BLENDED_OIT
@@ -247,7 +263,41 @@ private:
 		};
 		m_pSkybox = std::make_unique<CSkybox>(Faces);
 
-		m_Scene.load("scene_05.json");
+		SModelLoadOptions LoadOptions;
+#ifdef USING_TEXTURE_STREAMING
+		LoadOptions.StreamTextures = true;
+#endif
+#ifdef USING_PACKED_VERTEX
+		LoadOptions.PackVertices = true;
+#endif
+#ifdef USING_MERGED_MESH_BUFFERS
+		LoadOptions.MergeMeshBuffers = true;
+#endif
+#ifdef USING_MESH_LOD
+		LoadOptions.GenerateLODs = true;
+		CRenderer::getInstance()->enableLOD(true);
+#endif
+#ifdef USING_PRE_SKINNING
+		CRenderer::getInstance()->enablePreSkinning(true);
+#endif
+#ifdef USING_COMMAND_QUEUE
+		CRenderer::getInstance()->enableCommandQueue(true);
+#endif
+#ifdef USING_INSTANCE_BATCHING
+		CRenderer::getInstance()->enableInstanceBatching(true);
+#endif
+#ifdef USING_FRUSTUM_CULLING
+		CRenderer::getInstance()->enableFrustumCulling(true);
+#endif
+
+		SRasterState AccumulationState;
+		AccumulationState.IsCullFaceEnabled = false;
+		AccumulationState.IsDepthWriteEnabled = false;
+		AccumulationState.IsBlendEnabled = true;
+		AccumulationState.BlendDstFactor = GL_ONE;
+		m_pAccumulationState = std::make_unique<CPipelineState>(AccumulationState);
+
+		m_Scene.load("scene_05.json", LoadOptions);
 		m_OpaqueModels = m_Scene.getModelGroup("opaqueModels");
 		m_TransparentModels = m_Scene.getModelGroup("transparentModels");
 		for (auto pModel : m_TransparentModels)
@@ -485,10 +535,6 @@ private:
 		m_pOpaqueDepthTex->bindV(2);
 		m_pGenLinkedListShaderProgram->updateUniformTexture("uOpaqueDepthTex", m_pOpaqueDepthTex.get());
 
-		auto pCamera = CRenderer::getInstance()->fetchCamera();
-		m_pGenLinkedListShaderProgram->updateUniform1f("uNearPlane", pCamera->getNear());
-		m_pGenLinkedListShaderProgram->updateUniform1f("uFarPlane", pCamera->getFar());
-
 		for (auto Model : m_TransparentModels)
 		{
 			auto Material = m_Model2MaterialMap[Model];
@@ -545,16 +591,12 @@ private:
 		m_pGenerateMomentShaderProgram->updateUniformTexture("uOpaqueDepthTex", m_pOpaqueDepthTex.get());
 		m_pGenerateMomentShaderProgram->updateUniform4f("uWrappingZoneParameters", m_WrappingZoneParameters);
 
-		auto pCamera = CRenderer::getInstance()->fetchCamera();
-		m_pGenerateMomentShaderProgram->updateUniform1f("uNearPlane", pCamera->getNear());
-		m_pGenerateMomentShaderProgram->updateUniform1f("uFarPlane", pCamera->getFar());
-
 		for (auto Model : m_TransparentModels)
 		{
 			auto Material = m_Model2MaterialMap[Model];
 			m_pGenerateMomentShaderProgram->bind();
 			m_pGenerateMomentShaderProgram->updateUniform1f("uCoverage", Material.coverage);
-			CRenderer::getInstance()->draw(*Model, *m_pGenerateMomentShaderProgram);
+			CRenderer::getInstance()->draw(*Model, *m_pGenerateMomentShaderProgram, EVertexInput::PositionOnly);
 		}
 
 		CRenderer::getInstance()->setDepthMask(true);
@@ -578,9 +620,6 @@ private:
 		m_pReconstructTransmittanceShaderProgram->updateUniformTexture("uMomentB0Tex", m_pMomentB0Tex.get());
 		m_pReconstructTransmittanceShaderProgram->updateUniform4f("uWrappingZoneParameters", m_WrappingZoneParameters);
 
-		m_pReconstructTransmittanceShaderProgram->updateUniform1f("uNearPlane", pCamera->getNear());
-		m_pReconstructTransmittanceShaderProgram->updateUniform1f("uFarPlane", pCamera->getFar());
-
 		for (auto Model : m_TransparentModels)
 		{
 			auto Material = m_Model2MaterialMap[Model];
@@ -729,8 +768,6 @@ private:
 
 		__clearImages();
 
-		auto pCamera = CRenderer::getInstance()->fetchCamera();
-
 		//pass0: compute surface z
 		/*m_pWOITSurfaceZFrameBuffer->bind();
 
@@ -741,14 +778,12 @@ private:
 		m_pComputeSurfaceZSP->bind();
 		m_pOpaqueDepthTex->bindV(2);
 		m_pComputeSurfaceZSP->updateUniformTexture("uOpaqueDepthTex", m_pOpaqueDepthTex.get());
-		m_pComputeSurfaceZSP->updateUniform1f("uNearPlane", pCamera->getNear());
-		m_pComputeSurfaceZSP->updateUniform1f("uFarPlane", pCamera->getFar());
 
 		for (auto Model : m_TransparentModels)
 		{
 			auto Material = m_Model2MaterialMap[Model];
 			m_pComputeSurfaceZSP->bind();
-			CRenderer::getInstance()->draw(*Model, *m_pComputeSurfaceZSP);
+			CRenderer::getInstance()->draw(*Model, *m_pComputeSurfaceZSP, EVertexInput::PositionOnly);
 			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 		}
 
@@ -767,10 +802,7 @@ private:
 		m_pWOITFrameBuffer1->bind();
 
 		CRenderer::getInstance()->clear();
-		CRenderer::getInstance()->enableCullFace(false);
-		CRenderer::getInstance()->setDepthMask(false);
-		CRenderer::getInstance()->enableBlend(true);
-		CRenderer::getInstance()->setBlendFunc(GL_ONE, GL_ONE);
+		CRenderer::getInstance()->setPipelineState(*m_pAccumulationState);
 
 		m_pGenWaveletOpacityMapSP->bind();
 		m_pOpaqueDepthTex->bindV(2);
@@ -778,9 +810,6 @@ private:
 		m_pPsiLutTex->bindV(4);
 		m_pGenWaveletOpacityMapSP->updateUniformTexture("uPsiLutTex", m_pPsiLutTex.get());
 
-		m_pGenWaveletOpacityMapSP->updateUniform1f("uNearPlane", pCamera->getNear());
-		m_pGenWaveletOpacityMapSP->updateUniform1f("uFarPlane", pCamera->getFar());
-
 		m_pGenWaveletOpacityMapSP->updateUniform1i("uWOITCoeffNum", WOITCoeffNum);
 
 		float representativeDataBuffer[514] = { 0 };
@@ -795,7 +824,7 @@ private:
 			auto Material = m_Model2MaterialMap[Model];
 			m_pGenWaveletOpacityMapSP->bind();
 			m_pGenWaveletOpacityMapSP->updateUniform1f("uCoverage", Material.coverage);
-			CRenderer::getInstance()->draw(*Model, *m_pGenWaveletOpacityMapSP);
+			CRenderer::getInstance()->draw(*Model, *m_pGenWaveletOpacityMapSP, EVertexInput::PositionOnly);
 			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 		}
 
@@ -822,18 +851,13 @@ private:
 		m_pWOITFrameBuffer2->bind();
 
 		CRenderer::getInstance()->clear();
-		CRenderer::getInstance()->enableCullFace(false);
-		CRenderer::getInstance()->setDepthMask(false);
-		CRenderer::getInstance()->enableBlend(true);
-		CRenderer::getInstance()->setBlendFunc(GL_ONE, GL_ONE);
+		CRenderer::getInstance()->setPipelineState(*m_pAccumulationState);
 
 		m_pWOITReconstructTransmittanceSP->bind();
 		m_pOpaqueDepthTex->bindV(2);
 		m_pPsiIntegralLutTex->bindV(3);
 		m_pWOITReconstructTransmittanceSP->updateUniformTexture("uOpaqueDepthTex", m_pOpaqueDepthTex.get());
 		m_pWOITReconstructTransmittanceSP->updateUniformTexture("uPsiIntegralLutTex", m_pPsiIntegralLutTex.get());
-		m_pWOITReconstructTransmittanceSP->updateUniform1f("uNearPlane", pCamera->getNear());
-		m_pWOITReconstructTransmittanceSP->updateUniform1f("uFarPlane", pCamera->getFar());
 		m_pWOITReconstructTransmittanceSP->updateUniform1i("uWOITCoeffNum", WOITCoeffNum);
 		m_pWOITReconstructTransmittanceSP->updateUniform1fv("uRepresentativeData", 514, representativeDataBuffer);
 
@@ -931,6 +955,7 @@ private:
 	std::map<std::shared_ptr<CModel>, SMaterial>	m_Model2MaterialMap;
 	CScene m_Scene;
 
+	std::unique_ptr<CPipelineState> m_pAccumulationState;
 	std::unique_ptr<CShaderProgram> m_pOpaqueShaderProgram;
 	std::unique_ptr<CFrameBuffer>	m_pOpaqueFrameBuffer;
 	std::shared_ptr<CTexture2D>		m_pOpaqueColorTex;
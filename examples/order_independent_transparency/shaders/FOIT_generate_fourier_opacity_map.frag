@@ -7,8 +7,7 @@
 
 uniform sampler2D   uOpaqueDepthTex;
 uniform float		uCoverage;
-uniform float		uNearPlane;
-uniform float		uFarPlane;
+#include "frame_uniforms.glsl"
 uniform int			uFOITCoeffNum;
 
 layout(location = 0) in float _inFragDepth;
@@ -18,11 +18,9 @@ uniform sampler2D   uOpaqueDepthTex;
 layout(binding = 0, OIT_FLT_PRECISION) uniform image2DArray uFourierOpacityMaps;
 layout(binding = 1, rgba8ui) uniform uimage2DArray uQuantizedFourierOpacityMaps;
 
-uniform vec3	uViewPos = vec3(0.0);
+#include "frame_uniforms.glsl"
 uniform vec3	uDiffuseColor;
 uniform float	uCoverage;
-uniform float	uNearPlane;
-uniform float	uFarPlane;
 uniform int		uFOITCoeffNum;
 
 layout(location = 0) in vec3 _inPositionW;
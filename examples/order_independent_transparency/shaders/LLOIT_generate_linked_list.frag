@@ -19,9 +19,7 @@ uniform int			uMaxListNode;
 uniform sampler2D	uMaterialDiffuseTex;
 uniform sampler2D	uMaterialSpecularTex;
 uniform sampler2D   uOpaqueDepthTex;
-uniform vec3		uViewPos = vec3(0.0);
-uniform float		uNearPlane;
-uniform float		uFarPlane;
+#include "frame_uniforms.glsl"
 
 uniform vec3	uDiffuseColor;
 uniform vec3	uTransmittance;
@@ -7,12 +7,13 @@ layout(location = 2) out vec2 _outTexCoord;
 
 void main()
 {
-	vec4 pos = vec4(_inVertexPosition, 1.0);
-	vec4 normal = vec4(_inVertexNormal, 0.0);
+	vec4 pos = fetchVertexPosition();
+	vec4 normal = fetchVertexNormal();
 	if (uHasBones) boneTransform(pos, normal);
 
-	_outPositionW.xyz = vec3(uModelMatrix * pos);
-	_outNormalW = mat3(transpose(inverse(uModelMatrix))) * normal.xyz;
+	mat4 ModelMatrix = fetchModelMatrix();
+	_outPositionW.xyz = vec3(ModelMatrix * pos);
+	_outNormalW = mat3(transpose(inverse(ModelMatrix))) * normal.xyz;
 	_outTexCoord = _inVertexTexCoord;
 	gl_Position = uProjectionMatrix * uViewMatrix * vec4(_outPositionW.xyz, 1.0);
 }
\ No newline at end of file
@@ -6,8 +6,7 @@
 
 uniform sampler2D   uOpaqueDepthTex;
 uniform float		uCoverage;
-uniform float		uNearPlane;
-uniform float		uFarPlane;
+#include "frame_uniforms.glsl"
 uniform vec4		uWrappingZoneParameters;
 
 layout(binding = 1, rgba32f) uniform image2D uMomentsImage;
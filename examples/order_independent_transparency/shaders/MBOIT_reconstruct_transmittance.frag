@@ -11,11 +11,9 @@ uniform sampler2D   uOpaqueDepthTex;
 uniform sampler2D	uMomentB0Tex;
 layout(binding = 1, rgba32f) uniform image2D uMomentsImage;
 
-uniform vec3	uViewPos = vec3(0.0);
+#include "frame_uniforms.glsl"
 uniform vec3	uDiffuseColor;
 uniform float	uCoverage;
-uniform float	uNearPlane;
-uniform float	uFarPlane;
 uniform vec4	uWrappingZoneParameters;
 
 layout(location = 0) in vec3 _inPositionW;
@@ -8,7 +8,7 @@ uniform sampler2D	uMaterialDiffuseTex;
 uniform sampler2D	uMaterialSpecularTex;
 uniform sampler2D   uOpaqueDepthTex;
 
-uniform vec3	uViewPos = vec3(0.0);
+#include "frame_uniforms.glsl"
 uniform vec3	uDiffuseColor;
 uniform vec3	uTransmittance = vec3(0.0);
 uniform float	uCoverage;
@@ -4,8 +4,7 @@
 #include "common.glsl"
 
 uniform sampler2D   uOpaqueDepthTex;
-uniform float		uNearPlane;
-uniform float		uFarPlane;
+#include "frame_uniforms.glsl"
 
 
 layout(location = 0) in float _inFragDepth;
@@ -5,10 +5,9 @@ layout(location = 0) out float _outFragDepth;
 
 void main()
 {
-	vec4 pos = vec4(_inVertexPosition, 1.0);
-	vec4 normal = vec4(_inVertexNormal, 0.0);
-	if (uHasBones) boneTransform(pos, normal);
+	vec4 pos = fetchVertexPosition();
+	if (uHasBones) boneTransformPosition(pos);
 
-	gl_Position = uProjectionMatrix * uViewMatrix * uModelMatrix * pos;
+	gl_Position = uProjectionMatrix * uViewMatrix * fetchModelMatrix() * pos;
 	_outFragDepth = gl_Position.z / gl_Position.w;
 }
\ No newline at end of file
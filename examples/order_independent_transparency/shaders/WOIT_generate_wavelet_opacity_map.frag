@@ -8,8 +8,7 @@
 uniform sampler2D   uOpaqueDepthTex;
 uniform sampler2D	uPsiLutTex;
 uniform float		uCoverage;
-uniform float		uNearPlane;
-uniform float		uFarPlane;
+#include "frame_uniforms.glsl"
 uniform int			uWOITCoeffNum;
 
 layout(location = 0) in float _inFragDepth;
@@ -15,11 +15,9 @@ uniform sampler2D	uMaterialSpecularTex;
 uniform sampler2D   uOpaqueDepthTex;
 uniform sampler2D	uPsiIntegralLutTex;
 
-uniform vec3	uViewPos = vec3(0.0);
+#include "frame_uniforms.glsl"
 uniform vec3	uDiffuseColor;
 uniform float	uCoverage;
-uniform float	uNearPlane;
-uniform float	uFarPlane;
 uniform int		uWOITCoeffNum;
 
 layout(location = 0) in vec3 _inPositionW;
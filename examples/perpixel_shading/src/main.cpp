@@ -1,6 +1,7 @@
 #include "ApplicationBase.h"
 #include "ShaderProgram.h"
 #include "Model.h"
+#include "FileLocator.h"
 
 using namespace glt;
 
@@ -11,6 +12,8 @@ public:
 	{
 		setDisplayStatusHint();
 
+		CFileLocator::getInstance()->addFileSearchPath("../../resource");
+
 		m_pShaderProgram = std::make_unique<CShaderProgram>();
 		m_pShaderProgram->addShader("shaders/perpixel_shading_vs.glsl", EShaderType::VERTEX_SHADER);
 		m_pShaderProgram->addShader("shaders/perpixel_shading_fs.glsl", EShaderType::FRAGMENT_SHADER);
@@ -1,22 +1,89 @@
 #include "ApplicationBase.h"
 #include "ShaderProgram.h"
 #include "Model.h"
+#include "FileLocator.h"
+#include "BakedAnimation.h"
 
 using namespace glt;
 
+//#define USING_CROWD
+
+//#define USING_BAKED_ANIMATION
+
+//#define USING_POSE_BENCHMARK
+
+//#define USING_POSE_SCHEDULE_TEST
+
+#ifdef USING_CROWD
+constexpr int CROWD_SIZE = 16;
+#endif
+
+#ifdef USING_BAKED_ANIMATION
+constexpr int BAKED_CROWD_SIZE = 64;
+#endif
+
 class CMyApplication : public CApplicationBase
 {
 public:
 	bool _initV() override
 	{
+		CFileLocator::getInstance()->addFileSearchPath("../../resource");
+
 		m_pShaderProgram = std::make_unique<CShaderProgram>();
 		m_pShaderProgram->addShader("shaders/skeletal_animation.vert", EShaderType::VERTEX_SHADER);
 		m_pShaderProgram->addShader("shaders/skeletal_animation.frag", EShaderType::FRAGMENT_SHADER);
 
+#if defined(USING_BAKED_ANIMATION)
+		m_pBakedShaderProgram = std::make_unique<CShaderProgram>();
+		m_pBakedShaderProgram->addShader("shaders/baked_animation.vert", EShaderType::VERTEX_SHADER);
+		m_pBakedShaderProgram->addShader("shaders/skeletal_animation.frag", EShaderType::FRAGMENT_SHADER);
+
+		m_pModel = std::make_unique<CModel>("../../resource/models/sphere-bot/Armature_001-(COLLADA_3 (COLLAborative Design Activity)).dae");
+		m_pBakedAnimation = std::make_unique<CBakedAnimation>(*m_pModel);
+
+		CEntity Placement;
+		for (int i = 0; i < BAKED_CROWD_SIZE * BAKED_CROWD_SIZE; ++i)
+		{
+			Placement.setRotation(1.57, glm::vec3(1.0f, 0.0f, 0.0f));
+			Placement.setPosition(glm::vec3((i % BAKED_CROWD_SIZE - BAKED_CROWD_SIZE / 2) * 2.0f, 0.0f, -(i / BAKED_CROWD_SIZE) * 2.0f));
+
+			SBakedInstance Instance;
+			Instance.ModelMatrix = Placement.getModelMatrix();
+			Instance.ClipIndex = i % m_pBakedAnimation->getNumClips();
+			Instance.Speed = 0.8f + 0.4f * (i % 7) / 6.0f;
+			Instance.TimeOffset = 0.37f * i;
+			m_BakedInstances.push_back(Instance);
+		}
+
+		CRenderer::getInstance()->fetchCamera()->setPosition(glm::dvec3(0, 12, 24));
+#elif defined(USING_CROWD)
+		for (int i = 0; i < CROWD_SIZE * CROWD_SIZE; ++i)
+		{
+			auto pModel = std::make_shared<CModel>("../../resource/models/sphere-bot/Armature_001-(COLLADA_3 (COLLAborative Design Activity)).dae");
+			pModel->setRotation(1.57, glm::vec3(1.0f, 0.0f, 0.0f));
+			pModel->setPosition(glm::vec3((i % CROWD_SIZE - CROWD_SIZE / 2) * 2.0f, 0.0f, -(i / CROWD_SIZE) * 2.0f));
+			pModel->setAnimationSpeed(0.8f + 0.4f * (i % 7) / 6.0f);
+			pModel->setAnimationTimeOffset(0.37f * i);
+			m_Models.push_back(pModel);
+		}
+
+		CRenderer::getInstance()->fetchCamera()->setPosition(glm::dvec3(0, 6, 12));
+		CRenderer::getInstance()->enableAnimationLOD(true);
+		CRenderer::getInstance()->enableFrustumCulling(true);
+#else
 		m_pModel = std::make_unique<CModel>("../../resource/models/sphere-bot/Armature_001-(COLLADA_3 (COLLAborative Design Activity)).dae");
 		m_pModel->setRotation(1.57, glm::vec3(1.0f, 0.0f, 0.0f));
 
 		CRenderer::getInstance()->fetchCamera()->setPosition(glm::dvec3(0, 1.5, 6));
+#endif
+
+#ifdef USING_POSE_BENCHMARK
+		__benchmarkPoseEvaluation(m_pModel ? *m_pModel->getAsset() : *m_Models.front()->getAsset());
+#endif
+
+#ifdef USING_POSE_SCHEDULE_TEST
+		__testPoseSchedule();
+#endif
 
 		return true;
 	}
@@ -24,12 +91,97 @@ public:
 	void _renderV() override
 	{
 		CRenderer::getInstance()->clear();
+#if defined(USING_BAKED_ANIMATION)
+		CRenderer::getInstance()->drawInstances(*m_pModel, *m_pBakedAnimation, m_BakedInstances, *m_pBakedShaderProgram);
+#elif defined(USING_CROWD)
+		CRenderer::getInstance()->updatePoses(m_Models);
+		CRenderer::getInstance()->draw(m_Models, *m_pShaderProgram);
+#else
 		CRenderer::getInstance()->draw(*m_pModel, *m_pShaderProgram);
+#endif
 	}
 
 private:
+#ifdef USING_POSE_BENCHMARK
+	void __benchmarkPoseEvaluation(const CModelAsset& vAsset)
+	{
+		if (vAsset.getNumAnimationClips() == 0) return;
+
+		const int NumPoses = 20000;
+		const CSkeleton& Skeleton = vAsset.getSkeleton();
+		const SAnimationClip& Clip = vAsset.getAnimationClip(0);
+
+		double TimeInMS[2] = {};
+		float MaxDifference = 0.0f;
+		SPoseWorkspace Workspaces[2];
+		std::vector<glm::mat4> Poses[2];
+		const EPoseKernel Kernels[2] = { EPoseKernel::Scalar, EPoseKernel::SIMD };
+
+		for (int i = 0; i < 2; ++i)
+		{
+			CCPUTimer Timer;
+			Timer.start();
+			for (int k = 0; k < NumPoses; ++k) Skeleton.evaluatePose(Clip, k / 60.0f, Workspaces[i], Poses[i], Kernels[i]);
+			Timer.stop();
+			TimeInMS[i] = Timer.getElapsedTimeInMS();
+		}
+
+		for (int k = 0; k < 600; ++k)
+		{
+			for (int i = 0; i < 2; ++i) Skeleton.evaluatePose(Clip, k / 60.0f, Workspaces[i], Poses[i], Kernels[i]);
+			for (size_t b = 0; b < Poses[0].size(); ++b)
+				for (int c = 0; c < 4; ++c) for (int r = 0; r < 4; ++r) MaxDifference = std::max(MaxDifference, std::abs(Poses[0][b][c][r] - Poses[1][b][c][r]));
+		}
+
+		_OUTPUT_EVENT(format("Pose evaluation of %u nodes, %u bones: scalar %.3f us, %s %.3f us per pose (max difference %g)", Skeleton.getNumNodes(), Skeleton.getNumBones(),
+			1000.0 * TimeInMS[0] / NumPoses, CSkeleton::getSIMDInstructionSet(), 1000.0 * TimeInMS[1] / NumPoses, MaxDifference));
+	}
+#endif
+
+#ifdef USING_POSE_SCHEDULE_TEST
+	//steps one instance per stagger offset, starting on every frame phase, and checks that the time of the blended pose
+	//never goes back and stays on the wall time
+	void __testPoseSchedule()
+	{
+		const float FrameTime = 1.0f / 60.0f;
+		int NumFailures = 0;
+
+		for (unsigned Interval = 2; Interval <= 4; ++Interval)
+		{
+			for (unsigned StaggerOffset = 0; StaggerOffset < Interval; ++StaggerOffset)
+			{
+				for (unsigned FirstFrame = 0; FirstFrame < Interval; ++FirstFrame)
+				{
+					float SourceTime = 0.0f, TargetTime = 0.0f, LastPoseTime = -1.0f;
+					for (unsigned Frame = FirstFrame; Frame < FirstFrame + 8 * Interval; ++Frame)
+					{
+						float Time = Frame * FrameTime;
+						CModel::schedulePose(Time, Frame, FrameTime, Interval, StaggerOffset, Frame != FirstFrame, SourceTime, TargetTime);
+						float PoseTime = glm::mix(SourceTime, TargetTime, CModel::computePoseBlendFactor(Time, SourceTime, TargetTime));
+
+						if (PoseTime < LastPoseTime || std::abs(PoseTime - Time) > 1.0e-4f)
+						{
+							_OUTPUT_WARNING(format("Pose schedule (interval %u, stagger offset %u) shows time %f at frame %u, expected %f", Interval, StaggerOffset, PoseTime, Frame, Time));
+							++NumFailures;
+						}
+						LastPoseTime = PoseTime;
+					}
+				}
+			}
+		}
+
+		if (NumFailures == 0) _OUTPUT_EVENT("Pose schedule test passed");
+	}
+#endif
+
 	std::unique_ptr<CShaderProgram> m_pShaderProgram = nullptr;
 	std::unique_ptr<CModel> m_pModel = nullptr;
+	std::vector<std::shared_ptr<CModel>> m_Models;
+#ifdef USING_BAKED_ANIMATION
+	std::unique_ptr<CShaderProgram> m_pBakedShaderProgram = nullptr;
+	std::unique_ptr<CBakedAnimation> m_pBakedAnimation = nullptr;
+	std::vector<SBakedInstance> m_BakedInstances;
+#endif
 };
 
 int main()
@@ -0,0 +1,53 @@
+#version 460 core
+
+#include "frame_uniforms.glsl"
+#include "vertex_attributes.glsl"
+
+uniform int uNumBakedBones = 1;
+
+struct SBakedClip { uint FirstMatrix; uint NumFrames; float FramesPerSecond; float DurationInSeconds; };
+struct SBakedInstance { mat4 ModelMatrix; uint ClipIndex; float TimeOffset; float Speed; float Padding; };
+
+layout(std430, binding = 12) readonly buffer BakedBones { vec4 uBakedBoneRows[]; };
+layout(std430, binding = 13) readonly buffer BakedClips { SBakedClip uBakedClips[]; };
+layout(std430, binding = 14) readonly buffer BakedInstances { SBakedInstance uBakedInstances[]; };
+
+layout(location = 0) out vec3 _outPositionW;
+layout(location = 1) out vec3 _outNormalW;
+layout(location = 2) out vec2 _outTexCoord;
+
+mat4 fetchBakedBone(uint vFrameMatrix, int vBone)
+{
+	uint Row = 3 * (vFrameMatrix + uint(vBone));
+	return transpose(mat4(uBakedBoneRows[Row], uBakedBoneRows[Row + 1], uBakedBoneRows[Row + 2], vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+void main()
+{
+	SBakedInstance Instance = uBakedInstances[gl_InstanceID];
+	SBakedClip Clip = uBakedClips[Instance.ClipIndex];
+
+	float Frame = mod((uTime * Instance.Speed + Instance.TimeOffset) * Clip.FramesPerSecond, float(Clip.NumFrames));
+	uint Frame0 = min(uint(Frame), Clip.NumFrames - 1);
+	uint Frame1 = (Frame0 + 1) % Clip.NumFrames;
+	float Factor = Frame - float(Frame0);
+
+	uint FrameMatrix0 = Clip.FirstMatrix + Frame0 * uint(uNumBakedBones);
+	uint FrameMatrix1 = Clip.FirstMatrix + Frame1 * uint(uNumBakedBones);
+
+	mat4 BoneTransform = mat4(0.0);
+	for (int i = 0; i < 4; ++i)
+	{
+		if (_inBoneWeights[i] == 0.0) continue;
+		BoneTransform += mix(fetchBakedBone(FrameMatrix0, _inBoneIDs[i]), fetchBakedBone(FrameMatrix1, _inBoneIDs[i]), Factor) * _inBoneWeights[i];
+	}
+	if (_inBoneWeights == vec4(0.0)) BoneTransform = mat4(1.0);
+
+	vec4 pos = BoneTransform * fetchVertexPosition();
+	vec4 normal = BoneTransform * fetchVertexNormal();
+
+	_outPositionW = vec3(Instance.ModelMatrix * pos);
+	_outNormalW = mat3(transpose(inverse(Instance.ModelMatrix))) * normal.xyz;
+	_outTexCoord = _inVertexTexCoord;
+	gl_Position = uProjectionMatrix * uViewMatrix * vec4(_outPositionW, 1.0);
+}
\ No newline at end of file
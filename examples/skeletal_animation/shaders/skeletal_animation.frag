@@ -4,7 +4,7 @@
 uniform sampler2D uMaterialDiffuseTex;
 uniform sampler2D uMaterialSpecularTex;
 
-uniform vec3 uViewPos = vec3(0.0);
+#include "frame_uniforms.glsl"
 
 layout(location = 0) in vec3 _inPositionW;
 layout(location = 1) in vec3 _inNormalW;
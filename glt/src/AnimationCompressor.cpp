@@ -0,0 +1,314 @@
+#include "AnimationCompressor.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "Common.h"
+
+using namespace glt;
+
+namespace
+{
+	constexpr float QUANTIZED_VECTOR_MAX = 65535.0f;
+	constexpr float QUANTIZED_ROTATION_MAX = 32767.0f;
+	constexpr float SQRT_HALF = 0.70710678f;
+
+	//NOTE: a track during compression, vectors use xyz and rotations are quaternions in xyzw order
+	struct STrack
+	{
+		std::vector<float> Times;
+		std::vector<glm::vec4> Values;
+	};
+}
+
+//***********************************************************************************************
+//FUNCTION: lerps vectors, nlerps rotations along the shorter arc like the pose kernels do
+static glm::vec4 __blend(const glm::vec4& vA, const glm::vec4& vB, float vFactor, bool vIsRotation)
+{
+	if (!vIsRotation) return vA + (vB - vA) * vFactor;
+
+	glm::vec4 B = (glm::dot(vA, vB) < 0.0f) ? -vB : vB;
+	return glm::normalize(vA + (B - vA) * vFactor);
+}
+
+//***********************************************************************************************
+//FUNCTION: q and -q are the same rotation, so rotations are compared in the hemisphere of vA
+static float __computeDifference(const glm::vec4& vA, const glm::vec4& vB, bool vIsRotation)
+{
+	glm::vec4 B = (vIsRotation && glm::dot(vA, vB) < 0.0f) ? -vB : vB;
+	glm::vec4 Difference = glm::abs(vA - B);
+	return std::max(std::max(Difference.x, Difference.y), std::max(Difference.z, Difference.w));
+}
+
+//***********************************************************************************************
+//FUNCTION: the value of the track at vTime, held constant before the first and after the last key
+static glm::vec4 __sampleTrack(const STrack& vTrack, float vTime, bool vIsRotation)
+{
+	_ASSERTE(!vTrack.Times.empty());
+	if (vTrack.Times.size() == 1 || vTime <= vTrack.Times.front()) return vTrack.Values.front();
+	if (vTime >= vTrack.Times.back()) return vTrack.Values.back();
+
+	size_t End = std::upper_bound(vTrack.Times.begin(), vTrack.Times.end(), vTime) - vTrack.Times.begin();
+	size_t Start = End - 1;
+	float DeltaTime = vTrack.Times[End] - vTrack.Times[Start];
+	float Factor = (DeltaTime > 0.0f) ? (vTime - vTrack.Times[Start]) / DeltaTime : 0.0f;
+
+	return __blend(vTrack.Values[Start], vTrack.Values[End], Factor, vIsRotation);
+}
+
+//***********************************************************************************************
+//FUNCTION: greedy key reduction. Starting from the last kept key, a segment is stretched as long as every key it skips
+//          is reproduced within the tolerance by interpolating its ends. A track that only holds a value keeps one key
+static std::vector<unsigned> __reduceKeys(const STrack& vTrack, float vTolerance, bool vIsRotation)
+{
+	unsigned NumKeys = static_cast<unsigned>(vTrack.Times.size());
+	std::vector<unsigned> KeptKeys = { 0 };
+	if (NumKeys == 1) return KeptKeys;
+
+	unsigned Anchor = 0;
+	for (unsigned i = Anchor + 2; i < NumKeys; ++i)
+	{
+		bool IsReproduced = true;
+		for (unsigned k = Anchor + 1; k < i && IsReproduced; ++k)
+		{
+			float DeltaTime = vTrack.Times[i] - vTrack.Times[Anchor];
+			float Factor = (DeltaTime > 0.0f) ? (vTrack.Times[k] - vTrack.Times[Anchor]) / DeltaTime : 0.0f;
+			IsReproduced = __computeDifference(__blend(vTrack.Values[Anchor], vTrack.Values[i], Factor, vIsRotation), vTrack.Values[k], vIsRotation) <= vTolerance;
+		}
+
+		if (!IsReproduced)
+		{
+			Anchor = i - 1;
+			KeptKeys.push_back(Anchor);
+		}
+	}
+	KeptKeys.push_back(NumKeys - 1);
+
+	if (KeptKeys.size() == 2 && __computeDifference(vTrack.Values.front(), vTrack.Values.back(), vIsRotation) <= vTolerance) KeptKeys.pop_back();
+	return KeptKeys;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+static STrack __toTrack(const std::vector<SVectorKey>& vKeys)
+{
+	STrack Track;
+	for (const auto& Key : vKeys)
+	{
+		Track.Times.push_back(Key.Time);
+		Track.Values.push_back(glm::vec4(Key.Value, 0.0f));
+	}
+	return Track;
+}
+
+//***********************************************************************************************
+//FUNCTION: the rotations are normalized and flipped into the hemisphere of their predecessor, so that comparing
+//          neighboring keys component-wise is meaningful
+static STrack __toTrack(const std::vector<SRotationKey>& vKeys)
+{
+	STrack Track;
+	for (const auto& Key : vKeys)
+	{
+		glm::vec4 Rotation = glm::normalize(glm::vec4(Key.Value.x, Key.Value.y, Key.Value.z, Key.Value.w));
+		if (!Track.Values.empty() && glm::dot(Track.Values.back(), Rotation) < 0.0f) Rotation = -Rotation;
+
+		Track.Times.push_back(Key.Time);
+		Track.Values.push_back(Rotation);
+	}
+	return Track;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+static SVectorTrack __compressVectorTrack(const STrack& vTrack, float vTolerance)
+{
+	std::vector<unsigned> KeptKeys = __reduceKeys(vTrack, vTolerance, false);
+
+	glm::vec3 Min(FLT_MAX), Max(-FLT_MAX);
+	for (unsigned Key : KeptKeys)
+	{
+		Min = glm::min(Min, glm::vec3(vTrack.Values[Key]));
+		Max = glm::max(Max, glm::vec3(vTrack.Values[Key]));
+	}
+
+	SVectorTrack Track;
+	Track.Min = Min;
+	Track.Extent = Max - Min;
+	for (unsigned Key : KeptKeys)
+	{
+		std::array<unsigned short, 3> Value = {};
+		for (int k = 0; k < 3; ++k)
+		{
+			float Normalized = (Track.Extent[k] > 0.0f) ? (vTrack.Values[Key][k] - Min[k]) / Track.Extent[k] : 0.0f;
+			Value[k] = static_cast<unsigned short>(std::round(glm::clamp(Normalized, 0.0f, 1.0f) * QUANTIZED_VECTOR_MAX));
+		}
+
+		Track.Times.push_back(vTrack.Times[Key]);
+		Track.Values.push_back(Value);
+	}
+
+	return Track;
+}
+
+//***********************************************************************************************
+//FUNCTION: see SRotationTrack for the layout
+static std::array<unsigned short, 3> __encodeRotation(const glm::vec4& vRotation)
+{
+	const float Components[4] = { vRotation.x, vRotation.y, vRotation.z, vRotation.w };
+
+	unsigned Largest = 0;
+	for (unsigned i = 1; i < 4; ++i) if (std::abs(Components[i]) > std::abs(Components[Largest])) Largest = i;
+	float Sign = (Components[Largest] < 0.0f) ? -1.0f : 1.0f;
+
+	std::array<unsigned short, 3> Result = {};
+	for (unsigned i = 0, k = 0; i < 4; ++i)
+	{
+		if (i == Largest) continue;
+		float Normalized = glm::clamp(Sign * Components[i] / SQRT_HALF, -1.0f, 1.0f) * 0.5f + 0.5f;
+		Result[k++] = static_cast<unsigned short>(static_cast<unsigned>(std::round(Normalized * QUANTIZED_ROTATION_MAX)) << 1);
+	}
+	Result[0] |= static_cast<unsigned short>(Largest & 1u);
+	Result[1] |= static_cast<unsigned short>((Largest >> 1) & 1u);
+
+	return Result;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+static SRotationTrack __compressRotationTrack(const STrack& vTrack, float vTolerance)
+{
+	SRotationTrack Track;
+	for (unsigned Key : __reduceKeys(vTrack, vTolerance, true))
+	{
+		Track.Times.push_back(vTrack.Times[Key]);
+		Track.Values.push_back(__encodeRotation(vTrack.Values[Key]));
+	}
+	return Track;
+}
+
+//***********************************************************************************************
+//FUNCTION: decodes a compressed track back into floats for measuring the error
+static STrack __decodeTrack(const SVectorTrack& vTrack)
+{
+	STrack Track;
+	Track.Times = vTrack.Times;
+	for (unsigned i = 0; i < vTrack.Times.size(); ++i) Track.Values.push_back(glm::vec4(vTrack.decode(i), 0.0f));
+	return Track;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+static STrack __decodeTrack(const SRotationTrack& vTrack)
+{
+	STrack Track;
+	Track.Times = vTrack.Times;
+	for (unsigned i = 0; i < vTrack.Times.size(); ++i)
+	{
+		glm::quat Rotation = vTrack.decode(i);
+		Track.Values.push_back(glm::vec4(Rotation.x, Rotation.y, Rotation.z, Rotation.w));
+	}
+	return Track;
+}
+
+//***********************************************************************************************
+//FUNCTION: T * R * S of one sampled channel, vTracks holds its position, rotation and scaling track
+static glm::mat4 __composeTransform(const STrack* vTracks, float vTime)
+{
+	glm::vec4 Position = __sampleTrack(vTracks[0], vTime, false);
+	glm::vec4 q = __sampleTrack(vTracks[1], vTime, true);
+	glm::vec4 Scaling = __sampleTrack(vTracks[2], vTime, false);
+
+	glm::mat4 Transform(1.0f);
+	Transform[0] = glm::vec4(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.w * q.z), 2.0f * (q.x * q.z - q.w * q.y), 0.0f) * Scaling.x;
+	Transform[1] = glm::vec4(2.0f * (q.x * q.y - q.w * q.z), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z + q.w * q.x), 0.0f) * Scaling.y;
+	Transform[2] = glm::vec4(2.0f * (q.x * q.z + q.w * q.y), 2.0f * (q.y * q.z - q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y), 0.0f) * Scaling.z;
+	Transform[3] = glm::vec4(glm::vec3(Position), 1.0f);
+
+	return Transform;
+}
+
+//***********************************************************************************************
+//FUNCTION: the global transforms of all nodes at vTime, vTracks holds three tracks per channel and is empty for a
+//          channel the clip does not animate
+static void __computeGlobalTransforms(const std::vector<SSkeletonNode>& vNodes, const std::vector<STrack>& vTracks, float vTime, std::vector<glm::mat4>& voTransforms)
+{
+	voTransforms.resize(vNodes.size());
+	for (size_t i = 0; i < vNodes.size(); ++i)
+	{
+		const SSkeletonNode& Node = vNodes[i];
+		bool IsAnimated = Node.Channel >= 0 && !vTracks[3 * Node.Channel + 1].Times.empty();
+
+		glm::mat4 Local = IsAnimated ? __composeTransform(&vTracks[3 * Node.Channel], vTime) : Node.Transform;
+		voTransforms[i] = (Node.Parent >= 0) ? voTransforms[Node.Parent] * Local : Local;
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION: the joints are compared at every raw key time, where the dropped keys and the quantization are off the most
+SAnimationClip CAnimationCompressor::compress(const SRawAnimationClip& vClip, const std::vector<SSkeletonNode>& vNodes, const SAnimationCompressionOptions& vOptions,
+	SAnimationCompressionReport& voReport)
+{
+	voReport = SAnimationCompressionReport();
+
+	SAnimationClip Clip;
+	Clip.Name = vClip.Name;
+	Clip.Duration = vClip.Duration;
+	Clip.TicksPerSecond = vClip.TicksPerSecond;
+	Clip.Channels.resize(vClip.Channels.size());
+
+	std::vector<STrack> RawTracks(3 * vClip.Channels.size()), Tracks(3 * vClip.Channels.size());
+	std::vector<float> SampleTimes;
+	for (size_t i = 0; i < vClip.Channels.size(); ++i)
+	{
+		const SRawAnimationChannel& RawChannel = vClip.Channels[i];
+		if (RawChannel.RotationKeys.empty()) continue;
+		_ASSERTE(!RawChannel.PositionKeys.empty() && !RawChannel.ScalingKeys.empty());
+
+		RawTracks[3 * i] = __toTrack(RawChannel.PositionKeys);
+		RawTracks[3 * i + 1] = __toTrack(RawChannel.RotationKeys);
+		RawTracks[3 * i + 2] = __toTrack(RawChannel.ScalingKeys);
+
+		SAnimationChannel& Channel = Clip.Channels[i];
+		Channel.Positions = __compressVectorTrack(RawTracks[3 * i], vOptions.PositionTolerance);
+		Channel.Rotations = __compressRotationTrack(RawTracks[3 * i + 1], vOptions.RotationTolerance);
+		Channel.Scalings = __compressVectorTrack(RawTracks[3 * i + 2], vOptions.ScalingTolerance);
+
+		Tracks[3 * i] = __decodeTrack(Channel.Positions);
+		Tracks[3 * i + 1] = __decodeTrack(Channel.Rotations);
+		Tracks[3 * i + 2] = __decodeTrack(Channel.Scalings);
+
+		for (int k = 0; k < 3; ++k) SampleTimes.insert(SampleTimes.end(), RawTracks[3 * i + k].Times.begin(), RawTracks[3 * i + k].Times.end());
+
+		voReport.NumRawKeys += static_cast<unsigned>(RawChannel.PositionKeys.size() + RawChannel.RotationKeys.size() + RawChannel.ScalingKeys.size());
+		voReport.NumKeys += static_cast<unsigned>(Channel.Positions.Times.size() + Channel.Rotations.Times.size() + Channel.Scalings.Times.size());
+		voReport.RawMemorySize += (RawChannel.PositionKeys.size() + RawChannel.ScalingKeys.size()) * sizeof(SVectorKey) + RawChannel.RotationKeys.size() * sizeof(SRotationKey);
+	}
+	voReport.MemorySize = getMemorySize(Clip);
+
+	std::sort(SampleTimes.begin(), SampleTimes.end());
+	SampleTimes.erase(std::unique(SampleTimes.begin(), SampleTimes.end()), SampleTimes.end());
+
+	std::vector<glm::mat4> RawTransforms, Transforms;
+	for (float Time : SampleTimes)
+	{
+		__computeGlobalTransforms(vNodes, RawTracks, Time, RawTransforms);
+		__computeGlobalTransforms(vNodes, Tracks, Time, Transforms);
+		for (size_t i = 0; i < vNodes.size(); ++i)
+			voReport.MaxJointError = std::max(voReport.MaxJointError, glm::length(glm::vec3(RawTransforms[i][3]) - glm::vec3(Transforms[i][3])));
+	}
+
+	return Clip;
+}
+
+//***********************************************************************************************
+//FUNCTION: the key data only, without the bookkeeping of the containers
+size_t CAnimationCompressor::getMemorySize(const SAnimationClip& vClip)
+{
+	size_t Size = 0;
+	for (const auto& Channel : vClip.Channels)
+	{
+		for (const SVectorTrack* pTrack : { &Channel.Positions, &Channel.Scalings })
+			Size += pTrack->Times.size() * (sizeof(float) + sizeof(pTrack->Values[0])) + sizeof(pTrack->Min) + sizeof(pTrack->Extent);
+		Size += Channel.Rotations.Times.size() * (sizeof(float) + sizeof(Channel.Rotations.Values[0]));
+	}
+	return Size;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Skeleton.h"
+#include "Export.h"
+
+namespace glt
+{
+	struct SRawAnimationChannel
+	{
+		std::vector<SVectorKey> PositionKeys;
+		std::vector<SRotationKey> RotationKeys;
+		std::vector<SVectorKey> ScalingKeys;
+	};
+
+	//NOTE: a clip as imported, the channels follow the same rules as those of SAnimationClip
+	struct SRawAnimationClip
+	{
+		std::string Name;
+		float Duration = 0.0f;
+		float TicksPerSecond = 25.0f;
+		std::vector<SRawAnimationChannel> Channels;
+	};
+
+	//NOTE: a key is dropped when interpolating its neighbors reproduces it within the tolerance. Positions and scalings
+	//      are compared per component, rotations by the quaternion components
+	struct SAnimationCompressionOptions
+	{
+		float PositionTolerance = 1e-4f;
+		float RotationTolerance = 1e-4f;
+		float ScalingTolerance = 1e-4f;
+	};
+
+	//NOTE: the joint error is the largest distance between a joint of the raw and of the compressed clip, measured at
+	//      every raw key time in the space of the root node
+	struct SAnimationCompressionReport
+	{
+		unsigned NumRawKeys = 0;
+		unsigned NumKeys = 0;
+		size_t RawMemorySize = 0;
+		size_t MemorySize = 0;
+		float MaxJointError = 0.0f;
+	};
+
+	class GLT_DECLSPEC CAnimationCompressor
+	{
+	public:
+		static SAnimationClip compress(const SRawAnimationClip& vClip, const std::vector<SSkeletonNode>& vNodes, const SAnimationCompressionOptions& vOptions,
+			SAnimationCompressionReport& voReport);
+		static size_t getMemorySize(const SAnimationClip& vClip);
+
+	private:
+		CAnimationCompressor() = delete;
+	};
+}
\ No newline at end of file
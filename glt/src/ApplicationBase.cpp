@@ -4,6 +4,7 @@
 #include <imgui/imgui_impl_opengl3.h>
 #include "Window.h"
 #include "InputManager.h"
+#include "TextureCache.h"
 
 using namespace glt;
 
@@ -107,6 +108,26 @@ void glt::CApplicationBase::__renderGUI()
 	{
 		ImGui::Begin("Application Status");
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+		STextureCacheStatistics TextureCacheStatistics = CTextureCache::getInstance()->getStatistics();
+		ImGui::Text("Texture cache: %u textures (%.2f MB), hit rate %.1f%% (%u/%u), %.2f MB saved", TextureCacheStatistics.NumCachedTextures,
+			TextureCacheStatistics.CachedMemorySize / (1024.0 * 1024.0), TextureCacheStatistics.getHitRate() * 100.0f, TextureCacheStatistics.NumHits,
+			TextureCacheStatistics.NumRequests, TextureCacheStatistics.SavedMemorySize / (1024.0 * 1024.0));
+
+		const SRenderStatistics& RenderStatistics = CRenderer::getInstance()->getStatistics();
+		ImGui::Text("Triangles: %u drawn, %u at full detail (%u models)", RenderStatistics.NumDrawnTriangles,
+			RenderStatistics.NumFullDetailTriangles, RenderStatistics.NumDrawnModels);
+		ImGui::Text("Culling: %u models visible, %u models and %u meshes culled", RenderStatistics.NumDrawnModels, RenderStatistics.NumCulledModels,
+			RenderStatistics.NumCulledMeshes);
+		if (RenderStatistics.NumEvaluatedPoses + RenderStatistics.NumInterpolatedPoses > 0)
+			ImGui::Text("Pose evaluation: %.3f ms/frame (%u evaluated, %u interpolated, %u uploads)", RenderStatistics.PoseEvaluationTimeInMS,
+				RenderStatistics.NumEvaluatedPoses, RenderStatistics.NumInterpolatedPoses, RenderStatistics.NumUploadedPoses);
+		if (RenderStatistics.NumPreSkinnedVertices > 0)
+			ImGui::Text("Pre-skinning: %u vertices", RenderStatistics.NumPreSkinnedVertices);
+		ImGui::Text("Binds: %u programs, %u vertex arrays, %u textures (%u state changes elided)", RenderStatistics.NumProgramBinds,
+			RenderStatistics.NumVertexArrayBinds, RenderStatistics.NumTextureBinds, RenderStatistics.NumElidedStateChanges);
+		if (RenderStatistics.NumInstancedDraws > 0)
+			ImGui::Text("Instancing: %u models in %u instanced draws", RenderStatistics.NumInstancedModels, RenderStatistics.NumInstancedDraws);
 		ImGui::End();
 	}
 
@@ -0,0 +1,84 @@
+#include "BakedAnimation.h"
+#include <cmath>
+#include <algorithm>
+#include "Model.h"
+#include "ShaderStorageBuffer.h"
+
+using namespace glt;
+
+namespace
+{
+	//NOTE: must match the BakedBones and BakedClips storage blocks of the baked animation shaders
+	constexpr unsigned BAKED_BONE_BINDING = 12;
+	constexpr unsigned BAKED_CLIP_BINDING = 13;
+}
+
+//***********************************************************************************************
+//FUNCTION: every clip is sampled at a whole number of frames per loop, its frame rate is adjusted slightly so that the
+//          last frame blends back into the first. A model without clips gets a single clip holding its bind pose
+CBakedAnimation::CBakedAnimation(const CModel& vModel, float vFramesPerSecond)
+{
+	_ASSERTE(vModel.getAsset() && vModel.getAsset()->isUploaded() && vFramesPerSecond > 0.0f);
+	const CModelAsset& Asset = *vModel.getAsset();
+	const CSkeleton& Skeleton = Asset.getSkeleton();
+
+	m_NumBones = std::max(Skeleton.getNumBones(), 1u);
+
+	std::vector<glm::vec4> BoneRows;
+	auto appendPose = [&](const std::vector<glm::mat4>& vBoneTransforms)
+	{
+		for (unsigned i = 0; i < m_NumBones; ++i)
+		{
+			glm::mat4 Transform = (i < vBoneTransforms.size()) ? glm::transpose(vBoneTransforms[i]) : glm::mat4(1.0f);
+			BoneRows.insert(BoneRows.end(), { Transform[0], Transform[1], Transform[2] });
+		}
+	};
+
+	if (Asset.getNumAnimationClips() == 0)
+	{
+		m_Clips.push_back(SBakedClip{ 0, 1, vFramesPerSecond, 0.0f });
+		appendPose(std::vector<glm::mat4>());
+	}
+
+	SPoseWorkspace Workspace;
+	std::vector<glm::mat4> BoneTransforms;
+	for (unsigned i = 0; i < Asset.getNumAnimationClips(); ++i)
+	{
+		const SAnimationClip& Clip = Asset.getAnimationClip(i);
+
+		SBakedClip BakedClip;
+		BakedClip.FirstMatrix = static_cast<unsigned>(BoneRows.size() / 3);
+		BakedClip.DurationInSeconds = (Clip.TicksPerSecond > 0.0f) ? Clip.Duration / Clip.TicksPerSecond : 0.0f;
+		BakedClip.NumFrames = std::max(1u, static_cast<unsigned>(std::ceil(BakedClip.DurationInSeconds * vFramesPerSecond)));
+		BakedClip.FramesPerSecond = (BakedClip.DurationInSeconds > 0.0f) ? BakedClip.NumFrames / BakedClip.DurationInSeconds : vFramesPerSecond;
+
+		Workspace.Cursors.clear();
+		for (unsigned k = 0; k < BakedClip.NumFrames; ++k)
+		{
+			Skeleton.evaluatePose(Clip, k / BakedClip.FramesPerSecond, Workspace, BoneTransforms);
+			appendPose(BoneTransforms);
+		}
+
+		m_Clips.push_back(BakedClip);
+	}
+
+	m_MemorySize = BoneRows.size() * sizeof(glm::vec4) + m_Clips.size() * sizeof(SBakedClip);
+	m_pBoneBuffer = std::make_shared<CShaderStorageBuffer>(BoneRows.data(), static_cast<unsigned>(BoneRows.size() * sizeof(glm::vec4)), BAKED_BONE_BINDING);
+	m_pClipBuffer = std::make_shared<CShaderStorageBuffer>(m_Clips.data(), static_cast<unsigned>(m_Clips.size() * sizeof(SBakedClip)), BAKED_CLIP_BINDING);
+
+	_OUTPUT_EVENT(format("Baked %u clips of %u bones at %.1f fps (%.2f MB).", getNumClips(), m_NumBones, vFramesPerSecond, m_MemorySize / (1024.0 * 1024.0)));
+}
+
+//***********************************************************************************************
+//FUNCTION:
+CBakedAnimation::~CBakedAnimation()
+{
+}
+
+//***********************************************************************************************
+//FUNCTION:
+void CBakedAnimation::_bind() const
+{
+	m_pBoneBuffer->bindBase();
+	m_pClipBuffer->bindBase();
+}
\ No newline at end of file
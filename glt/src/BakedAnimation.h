@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+#include "Common.h"
+#include "Export.h"
+
+namespace glt
+{
+	class CModel;
+	class CShaderStorageBuffer;
+
+	//NOTE: must match the SBakedClip struct of the baked animation shaders
+	struct SBakedClip
+	{
+		unsigned FirstMatrix = 0;
+		unsigned NumFrames = 0;
+		float FramesPerSecond = 0.0f;
+		float DurationInSeconds = 0.0f;
+	};
+
+	//NOTE: must match the SBakedInstance struct of the baked animation shaders. An instance plays its clip at Speed times
+	//      the renderer time shifted by TimeOffset, the same way a CModel does
+	struct SBakedInstance
+	{
+		glm::mat4 ModelMatrix = glm::mat4(1.0f);
+		unsigned ClipIndex = 0;
+		float TimeOffset = 0.0f;
+		float Speed = 1.0f;
+		float Padding = 0.0f;
+	};
+
+	//NOTE: the poses of every clip of a model sampled at a fixed rate and kept on the GPU, so that instances drawn from it
+	//      need neither a CPU pose evaluation nor a palette upload. Each bone matrix is stored as its upper three rows, the
+	//      vertex shader blends the two frames around the instance time
+	class GLT_DECLSPEC CBakedAnimation
+	{
+	public:
+		CBakedAnimation(const CModel& vModel, float vFramesPerSecond = 30.0f);
+		~CBakedAnimation();
+
+		unsigned getNumClips() const { return static_cast<unsigned>(m_Clips.size()); }
+		unsigned getNumBones() const { return m_NumBones; }
+		const SBakedClip& getClip(unsigned vIndex) const { _ASSERTE(vIndex < m_Clips.size()); return m_Clips[vIndex]; }
+		size_t getMemorySize() const { return m_MemorySize; }
+
+	protected:
+		void _bind() const;
+
+	private:
+		_DISALLOW_COPY_AND_ASSIGN(CBakedAnimation);
+
+		std::vector<SBakedClip> m_Clips;
+		unsigned m_NumBones = 0;
+		size_t m_MemorySize = 0;
+
+		std::shared_ptr<CShaderStorageBuffer> m_pBoneBuffer;
+		std::shared_ptr<CShaderStorageBuffer> m_pClipBuffer;
+
+		friend class CRenderer;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "CpuFeatures.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+using namespace glt;
+
+//***********************************************************************************************
+//FUNCTION: CPUID leaf 7 reports AVX2, leaf 1 with XGETBV tells whether the OS has enabled the YMM state
+static bool __queryAVX2Support()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int Registers[4] = {};
+	__cpuid(Registers, 0);
+	if (Registers[0] < 7) return false;
+
+	__cpuid(Registers, 1);
+	const int OSXSAVE_BIT = 1 << 27, AVX_BIT = 1 << 28;
+	if ((Registers[2] & OSXSAVE_BIT) == 0 || (Registers[2] & AVX_BIT) == 0) return false;
+	if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+	__cpuidex(Registers, 7, 0);
+	const int AVX2_BIT = 1 << 5;
+	return (Registers[1] & AVX2_BIT) != 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+//***********************************************************************************************
+//FUNCTION:
+bool glt::isAVX2Supported()
+{
+	static const bool IsSupported = __queryAVX2Support();
+	return IsSupported;
+}
\ No newline at end of file
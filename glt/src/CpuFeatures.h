@@ -0,0 +1,9 @@
+#pragma once
+#include "Export.h"
+
+namespace glt
+{
+	//NOTE: the kernels compiled for AVX2 are only called where the CPU has AVX2 and the OS saves the YMM registers,
+	//      everywhere else their SSE2 or scalar versions are used
+	GLT_DECLSPEC bool isAVX2Supported();
+}
\ No newline at end of file
@@ -16,6 +16,13 @@ namespace glt
 		const glm::vec4& getRotation() const { return m_Rotation; }
 		const glm::vec4& getParameters() const { return m_Parameters; }
 
+		glm::mat4 getModelMatrix() const
+		{
+			glm::mat4 ModelMatrix = glm::translate(glm::mat4(1.0f), m_Position);
+			ModelMatrix = glm::rotate(ModelMatrix, m_Rotation.w, glm::vec3(m_Rotation));
+			return glm::scale(ModelMatrix, m_Scale);
+		}
+
 		void setPosition(const glm::vec3& vPosition) { m_Position = vPosition; }
 		void setScale(const glm::vec3& vScale) { m_Scale = vScale; }
 		void setRotation(float vAngle, glm::vec3 vAxis) { m_Rotation = glm::vec4(vAxis, 0.0); m_Rotation.w = vAngle; };
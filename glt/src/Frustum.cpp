@@ -0,0 +1,137 @@
+#include "Frustum.h"
+#include <cmath>
+#include "Common.h"
+#include "CpuFeatures.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GLT_CULL_SSE
+#endif
+
+using namespace glt;
+
+namespace
+{
+	//NOTE: the kernels read the boxes as six consecutive floats, Min before Max
+	static_assert(sizeof(SAABB) == 6 * sizeof(float), "The SIMD kernels expect SAABB to be six packed floats.");
+	constexpr unsigned NUM_PLANES = 6;
+}
+
+//***********************************************************************************************
+//FUNCTION: a box is outside of a plane when even its corner farthest along the plane normal is behind it, which is the
+//          distance of its center plus its half extent projected onto the absolute normal
+static bool __isBoxInside(const glm::vec4* vPlanes, const SAABB& vBox)
+{
+	glm::vec3 Center = 0.5f * (vBox.Min + vBox.Max);
+	glm::vec3 HalfExtent = 0.5f * (vBox.Max - vBox.Min);
+	for (unsigned i = 0; i < NUM_PLANES; ++i)
+	{
+		glm::vec3 Normal = glm::vec3(vPlanes[i]);
+		if (glm::dot(Normal, Center) + vPlanes[i].w + glm::dot(glm::abs(Normal), HalfExtent) < 0.0f) return false;
+	}
+
+	return true;
+}
+
+//***********************************************************************************************
+//FUNCTION: left, right, bottom, top, near and far plane, from the rows of the matrix as derived by Gribb and Hartmann
+CFrustum::CFrustum(const glm::mat4& vViewProjectionMatrix)
+{
+	glm::vec4 Rows[4];
+	for (int i = 0; i < 4; ++i)
+		Rows[i] = glm::vec4(vViewProjectionMatrix[0][i], vViewProjectionMatrix[1][i], vViewProjectionMatrix[2][i], vViewProjectionMatrix[3][i]);
+
+	m_Planes[0] = Rows[3] + Rows[0];
+	m_Planes[1] = Rows[3] - Rows[0];
+	m_Planes[2] = Rows[3] + Rows[1];
+	m_Planes[3] = Rows[3] - Rows[1];
+	m_Planes[4] = Rows[3] + Rows[2];
+	m_Planes[5] = Rows[3] - Rows[2];
+
+	for (auto& Plane : m_Planes)
+	{
+		float Length = glm::length(glm::vec3(Plane));
+		if (Length > 0.0f) Plane /= Length;
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION:
+bool CFrustum::isVisible(const SAABB& vBox) const
+{
+	return __isBoxInside(m_Planes, vBox);
+}
+
+//***********************************************************************************************
+//FUNCTION: writes 1 for every visible box and 0 for every culled one, returns the number of visible boxes. The SIMD kernel
+//          transposes a group of boxes into one register per component and tests the whole group against a plane at once,
+//          the boxes left over at the end are tested one by one
+unsigned CFrustum::cull(const std::vector<SAABB>& vBoxes, std::vector<unsigned char>& voIsVisible, ECullKernel vKernel) const
+{
+	voIsVisible.resize(vBoxes.size());
+
+	size_t NumBoxes = vBoxes.size();
+	size_t i = 0;
+	unsigned NumVisible = 0;
+
+	if (vKernel == ECullKernel::SIMD && NumBoxes > 0)
+	{
+		if (isAVX2Supported()) __cullAVX2(m_Planes, vBoxes.data(), NumBoxes, voIsVisible.data(), i, NumVisible);
+#if defined(GLT_CULL_SSE)
+		const __m128 Half = _mm_set1_ps(0.5f);
+		const __m128 Zero = _mm_setzero_ps();
+		const float* pData = &vBoxes[0].Min.x;
+		for (; i + 4 <= NumBoxes; i += 4)
+		{
+			const float* pBoxes = pData + i * 6;
+			__m128 Center[3], HalfExtent[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				__m128 Min = _mm_setr_ps(pBoxes[k], pBoxes[6 + k], pBoxes[12 + k], pBoxes[18 + k]);
+				__m128 Max = _mm_setr_ps(pBoxes[3 + k], pBoxes[9 + k], pBoxes[15 + k], pBoxes[21 + k]);
+				Center[k] = _mm_mul_ps(_mm_add_ps(Min, Max), Half);
+				HalfExtent[k] = _mm_mul_ps(_mm_sub_ps(Max, Min), Half);
+			}
+
+			__m128 Inside = _mm_cmpeq_ps(Zero, Zero);
+			for (const auto& Plane : m_Planes)
+			{
+				__m128 Distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Center[0], _mm_set1_ps(Plane.x)), _mm_mul_ps(Center[1], _mm_set1_ps(Plane.y))),
+					_mm_add_ps(_mm_mul_ps(Center[2], _mm_set1_ps(Plane.z)), _mm_set1_ps(Plane.w)));
+				__m128 Radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(HalfExtent[0], _mm_set1_ps(std::abs(Plane.x))),
+					_mm_mul_ps(HalfExtent[1], _mm_set1_ps(std::abs(Plane.y)))), _mm_mul_ps(HalfExtent[2], _mm_set1_ps(std::abs(Plane.z))));
+				Inside = _mm_and_ps(Inside, _mm_cmpge_ps(_mm_add_ps(Distance, Radius), Zero));
+			}
+
+			int Mask = _mm_movemask_ps(Inside);
+			for (int k = 0; k < 4; ++k)
+			{
+				voIsVisible[i + k] = static_cast<unsigned char>((Mask >> k) & 1);
+				NumVisible += voIsVisible[i + k];
+			}
+		}
+#endif
+	}
+
+	for (; i < NumBoxes; ++i)
+	{
+		voIsVisible[i] = __isBoxInside(m_Planes, vBoxes[i]) ? 1 : 0;
+		NumVisible += voIsVisible[i];
+	}
+
+	return NumVisible;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+const char* CFrustum::getSIMDInstructionSet()
+{
+	size_t NumTested = 0;
+	unsigned NumVisible = 0;
+	if (isAVX2Supported() && __cullAVX2(nullptr, nullptr, 0, nullptr, NumTested, NumVisible)) return "AVX2";
+#if defined(GLT_CULL_SSE)
+	return "SSE2";
+#else
+	return "none";
+#endif
+}
\ No newline at end of file
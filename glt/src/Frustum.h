@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "Mesh.h"
+#include "Export.h"
+
+namespace glt
+{
+	enum class ECullKernel : unsigned char
+	{
+		SIMD = 0,
+		Scalar,
+	};
+
+	//NOTE: the six planes of a view frustum in world space, extracted from the view-projection matrix and normalized so that
+	//      a point is inside where all of them are non-negative. A box is culled once it lies completely outside one plane,
+	//      a box outside near a corner of the frustum may pass. The SIMD kernel tests 8 boxes at once with AVX2,
+	//      where the CPU has it, and 4 with SSE
+	class GLT_DECLSPEC CFrustum
+	{
+	public:
+		CFrustum() = default;
+		CFrustum(const glm::mat4& vViewProjectionMatrix);
+
+		const glm::vec4& getPlane(unsigned vIndex) const { _ASSERTE(vIndex < 6); return m_Planes[vIndex]; }
+
+		bool isVisible(const SAABB& vBox) const;
+		unsigned cull(const std::vector<SAABB>& vBoxes, std::vector<unsigned char>& voIsVisible, ECullKernel vKernel = ECullKernel::SIMD) const;
+
+		static const char* getSIMDInstructionSet();
+
+	private:
+		static bool __cullAVX2(const glm::vec4* vPlanes, const SAABB* vBoxes, size_t vNumBoxes, unsigned char* voIsVisible, size_t& vioNumTested, unsigned& vioNumVisible);
+
+		glm::vec4 m_Planes[6] = {};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "Frustum.h"
+#include <immintrin.h>
+
+//NOTE: glt.vcxproj compiles this file alone with /arch:AVX2, the kernel is only called once isAVX2Supported() said so.
+//      Nothing here calls into inline code of other headers, whose AVX2 copy the linker could pick for other files
+#if defined(__AVX2__)
+#define GLT_CULL_AVX2
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#pragma GCC target("avx2")
+#define GLT_CULL_AVX2
+#endif
+
+using namespace glt;
+
+//***********************************************************************************************
+//FUNCTION: tests groups of 8 boxes from vioNumTested on and leaves the rest to the caller. Returns false when this file
+//          was not compiled for AVX2, a call without boxes only asks for that
+bool CFrustum::__cullAVX2(const glm::vec4* vPlanes, const SAABB* vBoxes, size_t vNumBoxes, unsigned char* voIsVisible, size_t& vioNumTested, unsigned& vioNumVisible)
+{
+#if defined(GLT_CULL_AVX2)
+	if (vNumBoxes == 0) return true;
+
+	const __m256i Offsets = _mm256_setr_epi32(0, 6, 12, 18, 24, 30, 36, 42);
+	const __m256 Half = _mm256_set1_ps(0.5f);
+	const __m256 Zero = _mm256_setzero_ps();
+
+	__m256 Normals[6][3], Distances[6];
+	for (int p = 0; p < 6; ++p)
+	{
+		const float Plane[4] = { vPlanes[p].x, vPlanes[p].y, vPlanes[p].z, vPlanes[p].w };
+		for (int k = 0; k < 3; ++k) Normals[p][k] = _mm256_set1_ps(Plane[k]);
+		Distances[p] = _mm256_set1_ps(Plane[3]);
+	}
+
+	size_t i = vioNumTested;
+	for (; i + 8 <= vNumBoxes; i += 8)
+	{
+		const float* pBoxes = &vBoxes[i].Min.x;
+		__m256 Center[3], HalfExtent[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			__m256 Min = _mm256_i32gather_ps(pBoxes + k, Offsets, 4);
+			__m256 Max = _mm256_i32gather_ps(pBoxes + 3 + k, Offsets, 4);
+			Center[k] = _mm256_mul_ps(_mm256_add_ps(Min, Max), Half);
+			HalfExtent[k] = _mm256_mul_ps(_mm256_sub_ps(Max, Min), Half);
+		}
+
+		__m256 Inside = _mm256_cmp_ps(Zero, Zero, _CMP_EQ_OQ);
+		for (int p = 0; p < 6; ++p)
+		{
+			__m256 Distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Center[0], Normals[p][0]), _mm256_mul_ps(Center[1], Normals[p][1])),
+				_mm256_add_ps(_mm256_mul_ps(Center[2], Normals[p][2]), Distances[p]));
+			__m256 Radius = _mm256_setzero_ps();
+			for (int k = 0; k < 3; ++k) Radius = _mm256_add_ps(Radius, _mm256_mul_ps(HalfExtent[k], _mm256_andnot_ps(_mm256_set1_ps(-0.0f), Normals[p][k])));
+			Inside = _mm256_and_ps(Inside, _mm256_cmp_ps(_mm256_add_ps(Distance, Radius), Zero, _CMP_GE_OQ));
+		}
+
+		int Mask = _mm256_movemask_ps(Inside);
+		for (int k = 0; k < 8; ++k)
+		{
+			voIsVisible[i + k] = static_cast<unsigned char>((Mask >> k) & 1);
+			vioNumVisible += voIsVisible[i + k];
+		}
+	}
+
+	vioNumTested = i;
+	return true;
+#else
+	return false;
+#endif
+}
\ No newline at end of file
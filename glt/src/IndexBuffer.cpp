@@ -11,6 +11,15 @@ CIndexBuffer::CIndexBuffer(const unsigned int* vData, unsigned int vCount, unsig
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, vCount * sizeof(unsigned int), vData, vUsage);
 }
 
+//********************************************************************
+//FUNCTION:
+CIndexBuffer::CIndexBuffer(const unsigned short* vData, unsigned int vCount, unsigned int vUsage) : m_Count(vCount), m_Type(GL_UNSIGNED_SHORT)
+{
+	glGenBuffers(1, &m_ObjectID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ObjectID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, vCount * sizeof(unsigned short), vData, vUsage);
+}
+
 //********************************************************************
 //FUNCTION:
 CIndexBuffer::~CIndexBuffer()
@@ -8,15 +8,21 @@ namespace glt
 	{
 	public:
 		CIndexBuffer(const unsigned int* vData, unsigned int vCount, unsigned int vUsage = GL_STATIC_DRAW);
+		CIndexBuffer(const unsigned short* vData, unsigned int vCount, unsigned int vUsage = GL_STATIC_DRAW);
 		~CIndexBuffer();
 
 		void bind() const;
 		void unbind() const;
 
 		unsigned int getCount() const { return m_Count; }
+		unsigned int getType() const { return m_Type; }
+		unsigned int getSize() const { return m_Count * (m_Type == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int)); }
+
+		static bool canUseShortIndices(unsigned int vNumVertices) { return vNumVertices < 65536; }
 
 	private:
 		unsigned int m_ObjectID = 0;
 		unsigned int m_Count = 0;
+		unsigned int m_Type = GL_UNSIGNED_INT;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "MappedFile.h"
+#ifdef _WINDOWS
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+
+using namespace glt;
+
+//***********************************************************************************************
+//FUNCTION:
+CMappedFile::~CMappedFile()
+{
+	close();
+}
+
+//***********************************************************************************************
+//FUNCTION: map the whole file read-only into the address space of the process
+bool CMappedFile::open(const std::string& vFilePath)
+{
+	close();
+
+#ifdef _WINDOWS
+	HANDLE FileHandle = CreateFileA(vFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (FileHandle == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(FileHandle, &FileSize) || FileSize.QuadPart == 0) { CloseHandle(FileHandle); return false; }
+
+	HANDLE MappingHandle = CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!MappingHandle) { CloseHandle(FileHandle); return false; }
+
+	void* pData = MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!pData) { CloseHandle(MappingHandle); CloseHandle(FileHandle); return false; }
+
+	m_FileHandle = FileHandle;
+	m_MappingHandle = MappingHandle;
+	m_pData = static_cast<const unsigned char*>(pData);
+	m_Size = static_cast<size_t>(FileSize.QuadPart);
+#else
+	int FileDescriptor = ::open(vFilePath.c_str(), O_RDONLY);
+	if (FileDescriptor < 0) return false;
+
+	struct stat FileStat;
+	if (fstat(FileDescriptor, &FileStat) != 0 || FileStat.st_size == 0) { ::close(FileDescriptor); return false; }
+
+	void* pData = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+	if (pData == MAP_FAILED) { ::close(FileDescriptor); return false; }
+
+	m_FileDescriptor = FileDescriptor;
+	m_pData = static_cast<const unsigned char*>(pData);
+	m_Size = static_cast<size_t>(FileStat.st_size);
+#endif
+
+	return true;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+void CMappedFile::close()
+{
+#ifdef _WINDOWS
+	if (m_pData) UnmapViewOfFile(m_pData);
+	if (m_MappingHandle) CloseHandle(m_MappingHandle);
+	if (m_FileHandle) CloseHandle(m_FileHandle);
+	m_MappingHandle = nullptr;
+	m_FileHandle = nullptr;
+#else
+	if (m_pData) munmap(const_cast<unsigned char*>(m_pData), m_Size);
+	if (m_FileDescriptor >= 0) ::close(m_FileDescriptor);
+	m_FileDescriptor = -1;
+#endif
+
+	m_pData = nullptr;
+	m_Size = 0;
+}
\ No newline at end of file
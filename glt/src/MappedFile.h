@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include "Common.h"
+#include "Export.h"
+
+namespace glt
+{
+	class GLT_DECLSPEC CMappedFile
+	{
+	public:
+		CMappedFile() = default;
+		~CMappedFile();
+
+		bool open(const std::string& vFilePath);
+		void close();
+
+		bool isOpen() const { return m_pData != nullptr; }
+		const unsigned char* getData() const { return m_pData; }
+		size_t getSize() const { return m_Size; }
+
+	private:
+		_DISALLOW_COPY_AND_ASSIGN(CMappedFile);
+
+		const unsigned char* m_pData = nullptr;
+		size_t m_Size = 0;
+
+#ifdef _WINDOWS
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+#else
+		int m_FileDescriptor = -1;
+#endif
+	};
+}
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "Mesh.h"
 #include <string>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <glm/gtc/packing.hpp>
 #include "ShaderProgram.h"
 #include "Renderer.h"
 #include "Texture.h"
@@ -11,77 +15,525 @@ using namespace glt;
 //FUNCTION:
 CMesh::CMesh(const std::vector<SVertex>& vVertices, const std::vector<unsigned int>& vIndices, const std::vector<std::shared_ptr<CTexture2D>>& vTextures,
 	const std::vector<SUniformInfo>& vUniforms, const SAABB& vAABB)
+	: CMesh(vVertices.data(), vVertices.size(), vIndices.data(), vIndices.size(), vTextures, vUniforms, vAABB)
 {
-	m_Vertices = vVertices;
-	m_Indices = vIndices;
-	m_Textures = vTextures;
-	m_Uniforms = vUniforms;
-	m_AABB = vAABB;
+}
+
+namespace
+{
+	struct SShadingAttributes
+	{
+		glm::vec3 Normal;
+		glm::vec2 TexCoords;
+	};
+
+	struct SSkinAttributes
+	{
+		glm::ivec4 BoneIDs;
+		glm::vec4  BoneWeights;
+	};
+
+	struct SPackedPosition
+	{
+		unsigned short Position[4];
+	};
+
+	struct SPackedShadingAttributes
+	{
+		short          Normal[2];
+		unsigned short TexCoords[2];
+	};
+
+	struct SPackedSkinAttributes
+	{
+		unsigned char BoneIDs[4];
+		unsigned char BoneWeights[4];
+	};
+
+	//NOTE: must match the storage blocks of shaders/pre_skinning_cs.glsl
+	constexpr unsigned SKINNING_POSITION_BINDING = 8;
+	constexpr unsigned SKINNING_SHADING_BINDING = 9;
+	constexpr unsigned SKINNING_SKIN_BINDING = 10;
+	constexpr unsigned SKINNED_VERTEX_BINDING = 11;
+	constexpr unsigned SKINNING_GROUP_SIZE = 64;
+
+	//NOTE: must match the attribute locations of shaders/vertex_attributes.glsl
+	constexpr unsigned BONE_ID_LOCATION = 3;
+	constexpr unsigned BONE_WEIGHT_LOCATION = 4;
+}
+
+//**********************************************************************************************
+//FUNCTION: textures passed without a part are bound to the sampler named by their texture name
+static std::vector<SMeshTexture> __toMeshTextures(const std::vector<std::shared_ptr<CTexture2D>>& vTextures)
+{
+	std::vector<SMeshTexture> Textures;
+	for (const auto& pTexture : vTextures) Textures.push_back(SMeshTexture{ pTexture->getTextureName(), pTexture });
+	return Textures;
+}
+
+//**********************************************************************************************
+//FUNCTION:
+CMesh::CMesh(const SVertex* vVertices, unsigned int vNumVertices, const unsigned int* vIndices, unsigned int vNumIndices, const std::vector<std::shared_ptr<CTexture2D>>& vTextures,
+	const std::vector<SUniformInfo>& vUniforms, const SAABB& vAABB, bool vPackVertices)
+	: CMesh(std::vector<SMeshPart>{ SMeshPart{ vVertices, vNumVertices, vIndices, vNumIndices, __toMeshTextures(vTextures), vUniforms, vAABB } }, vPackVertices)
+{
+}
+
+//**********************************************************************************************
+//FUNCTION: the vertex and index data are uploaded to the GPU directly and are not kept on the CPU side. Several parts
+//          share one vertex and one index allocation and are addressed with base vertex/first index offsets
+CMesh::CMesh(const std::vector<SMeshPart>& vParts, bool vPackVertices)
+{
+	_ASSERTE(!vParts.empty());
+
+	const SVertex* pVertices = vParts[0].pVertices;
+	unsigned int NumVertices = vParts[0].NumVertices;
+	unsigned int MaxPartVertices = 0;
+	size_t NumLODs = 1;
+
+	std::vector<SVertex> MergedVertices;
+	if (vParts.size() > 1)
+	{
+		for (const auto& Part : vParts) MergedVertices.insert(MergedVertices.end(), Part.pVertices, Part.pVertices + Part.NumVertices);
+		pVertices = MergedVertices.data();
+		NumVertices = static_cast<unsigned int>(MergedVertices.size());
+	}
+
+	m_AABB = vParts[0].AABB;
+	for (const auto& Part : vParts)
+	{
+		_ASSERTE(Part.pVertices && Part.pIndices);
+		m_AABB.Min = glm::min(m_AABB.Min, Part.AABB.Min);
+		m_AABB.Max = glm::max(m_AABB.Max, Part.AABB.Max);
+		MaxPartVertices = std::max(MaxPartVertices, Part.NumVertices);
+		NumLODs = std::max(NumLODs, Part.LODs.size() + 1);
+	}
+
+	//NOTE: the index ranges (first index, count) of every part and level, a level missing in a part reuses its coarsest one
+	std::vector<unsigned int> Indices;
+	std::vector<std::vector<std::pair<unsigned, unsigned>>> IndexRanges(vParts.size());
+	m_NumTrianglesPerLOD.assign(NumLODs, 0);
+	for (size_t i = 0; i < vParts.size(); ++i)
+	{
+		IndexRanges[i].push_back(std::make_pair(static_cast<unsigned>(Indices.size()), vParts[i].NumIndices));
+		Indices.insert(Indices.end(), vParts[i].pIndices, vParts[i].pIndices + vParts[i].NumIndices);
+		for (const auto& LOD : vParts[i].LODs)
+		{
+			IndexRanges[i].push_back(std::make_pair(static_cast<unsigned>(Indices.size()), LOD.NumIndices));
+			Indices.insert(Indices.end(), LOD.pIndices, LOD.pIndices + LOD.NumIndices);
+		}
+		while (IndexRanges[i].size() < NumLODs) IndexRanges[i].push_back(IndexRanges[i].back());
+
+		for (size_t k = 0; k < NumLODs; ++k) m_NumTrianglesPerLOD[k] += IndexRanges[i][k].second / 3;
+	}
+
+	if (vParts.size() > 1)
+	{
+		m_Parts.resize(vParts.size());
+		for (size_t i = 0; i < vParts.size(); ++i)
+		{
+			m_Parts[i].AABB = vParts[i].AABB;
+			for (size_t k = 0; k < NumLODs; ++k) m_Parts[i].NumTrianglesPerLOD.push_back(IndexRanges[i][k].second / 3);
+		}
+	}
+
+	m_HasSkin = std::any_of(pVertices, pVertices + NumVertices, [](const SVertex& vVertex) { return vVertex.BoneWeights != glm::vec4(0.0f); });
+
+	bool HasOnlyByteBoneIDs = std::all_of(pVertices, pVertices + NumVertices, [](const SVertex& vVertex) { return glm::all(glm::lessThan(vVertex.BoneIDs, glm::ivec4(256))); });
+	if (vPackVertices && !HasOnlyByteBoneIDs) _OUTPUT_WARNING("The mesh references more than 256 bones and is uploaded unpacked.");
+
+	if (vPackVertices && HasOnlyByteBoneIDs) __setupPackedMesh(pVertices, NumVertices);
+	else __setupMesh(pVertices, NumVertices);
+
+	__setupIndexBuffer(Indices.data(), static_cast<unsigned int>(Indices.size()), CIndexBuffer::canUseShortIndices(MaxPartVertices));
+	__setupDrawBatches(vParts, IndexRanges);
+}
+
+//**********************************************************************************************
+//FUNCTION:
+void CMesh::__setupMesh(const SVertex* vVertices, unsigned int vNumVertices)
+{
+	std::vector<glm::vec3> Positions(vNumVertices);
+	std::vector<SShadingAttributes> ShadingAttributes(vNumVertices);
+	std::vector<SSkinAttributes> SkinAttributes(m_HasSkin ? vNumVertices : 0);
+	for (unsigned int i = 0; i < vNumVertices; ++i)
+	{
+		Positions[i] = vVertices[i].Position;
+		ShadingAttributes[i] = { vVertices[i].Normal, vVertices[i].TexCoords };
+		if (m_HasSkin) SkinAttributes[i] = { vVertices[i].BoneIDs, vVertices[i].BoneWeights };
+	}
+
+	CVertexArrayLayout PositionLayout;
+	PositionLayout.push<float>(3);
+
+	CVertexArrayLayout ShadingLayout;
+	ShadingLayout.push<float>(3);
+	ShadingLayout.push<float>(2);
 
-	__setupMesh();
+	CVertexArrayLayout SkinLayout;
+	SkinLayout.push<int>(4);
+	SkinLayout.push<float>(4);
+
+	__setupVertexArrays(Positions.data(), PositionLayout, ShadingAttributes.data(), ShadingLayout, SkinAttributes.data(), SkinLayout, vNumVertices);
 }
 
 //**********************************************************************************************
 //FUNCTION:
-void CMesh::__setupMesh()
+static glm::vec2 __encodeOctahedral(const glm::vec3& vNormal)
+{
+	glm::vec3 Normal = vNormal / (std::abs(vNormal.x) + std::abs(vNormal.y) + std::abs(vNormal.z) + 1e-20f);
+	glm::vec2 Result(Normal.x, Normal.y);
+	if (Normal.z < 0.0f)
+	{
+		Result.x = (1.0f - std::abs(Normal.y)) * (Normal.x >= 0.0f ? 1.0f : -1.0f);
+		Result.y = (1.0f - std::abs(Normal.x)) * (Normal.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return Result;
+}
+
+//**********************************************************************************************
+//FUNCTION: the weights are quantized so that they still sum up to 255
+static void __quantizeBoneWeights(const glm::vec4& vWeights, unsigned char voWeights[4])
+{
+	float Sum = vWeights.x + vWeights.y + vWeights.z + vWeights.w;
+	if (Sum <= 0.0f) { voWeights[0] = voWeights[1] = voWeights[2] = voWeights[3] = 0; return; }
+
+	int Total = 0, Largest = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		voWeights[i] = static_cast<unsigned char>(std::round(glm::clamp(vWeights[i] / Sum, 0.0f, 1.0f) * 255.0f));
+		Total += voWeights[i];
+		if (voWeights[i] > voWeights[Largest]) Largest = i;
+	}
+	voWeights[Largest] = static_cast<unsigned char>(glm::clamp(voWeights[Largest] + 255 - Total, 0, 255));
+}
+
+//**********************************************************************************************
+//FUNCTION: the position is unorm16 relative to the mesh bounds, the normal snorm16 octahedral, the texture coordinates
+//          half floats and the skin data uint8/unorm8, which is 8 bytes per stream instead of 12/20/32
+void CMesh::__setupPackedMesh(const SVertex* vVertices, unsigned int vNumVertices)
+{
+	glm::vec3 Min(FLT_MAX), Max(-FLT_MAX);
+	for (unsigned int i = 0; i < vNumVertices; ++i)
+	{
+		Min = glm::min(Min, vVertices[i].Position);
+		Max = glm::max(Max, vVertices[i].Position);
+	}
+	m_PositionOffset = Min;
+	m_PositionScale = Max - Min;
+	glm::vec3 InvScale = glm::vec3(m_PositionScale.x > 0.0f ? 1.0f / m_PositionScale.x : 0.0f, m_PositionScale.y > 0.0f ? 1.0f / m_PositionScale.y : 0.0f, m_PositionScale.z > 0.0f ? 1.0f / m_PositionScale.z : 0.0f);
+
+	std::vector<SPackedPosition> Positions(vNumVertices);
+	std::vector<SPackedShadingAttributes> ShadingAttributes(vNumVertices);
+	std::vector<SPackedSkinAttributes> SkinAttributes(m_HasSkin ? vNumVertices : 0);
+	for (unsigned int i = 0; i < vNumVertices; ++i)
+	{
+		const SVertex& Vertex = vVertices[i];
+
+		glm::vec3 Position = glm::clamp((Vertex.Position - m_PositionOffset) * InvScale, 0.0f, 1.0f);
+		for (int k = 0; k < 3; ++k) Positions[i].Position[k] = static_cast<unsigned short>(std::round(Position[k] * 65535.0f));
+		Positions[i].Position[3] = 0;
+
+		glm::vec2 Normal = __encodeOctahedral(Vertex.Normal);
+		for (int k = 0; k < 2; ++k) ShadingAttributes[i].Normal[k] = static_cast<short>(std::round(glm::clamp(Normal[k], -1.0f, 1.0f) * 32767.0f));
+		ShadingAttributes[i].TexCoords[0] = glm::packHalf1x16(Vertex.TexCoords.x);
+		ShadingAttributes[i].TexCoords[1] = glm::packHalf1x16(Vertex.TexCoords.y);
+
+		if (!m_HasSkin) continue;
+		for (int k = 0; k < 4; ++k) SkinAttributes[i].BoneIDs[k] = static_cast<unsigned char>(Vertex.BoneIDs[k]);
+		__quantizeBoneWeights(Vertex.BoneWeights, SkinAttributes[i].BoneWeights);
+	}
+
+	CVertexArrayLayout PositionLayout;
+	PositionLayout.push(GL_UNSIGNED_SHORT, 4, true);
+
+	CVertexArrayLayout ShadingLayout;
+	ShadingLayout.push(GL_SHORT, 2, true);
+	ShadingLayout.push(GL_HALF_FLOAT, 2, false);
+
+	CVertexArrayLayout SkinLayout;
+	SkinLayout.push(GL_UNSIGNED_BYTE, 4, false, true);
+	SkinLayout.push(GL_UNSIGNED_BYTE, 4, true);
+
+	m_IsVertexPacked = true;
+	__setupVertexArrays(Positions.data(), PositionLayout, ShadingAttributes.data(), ShadingLayout, SkinAttributes.data(), SkinLayout, vNumVertices);
+}
+
+//**********************************************************************************************
+//FUNCTION: the position, shading and skin attributes live in separate buffers. Besides the full vertex array there is
+//          a second one fetching only the position (and the skin for skinned meshes) for depth-only passes
+void CMesh::__setupVertexArrays(const void* vPositions, const CVertexArrayLayout& vPositionLayout, const void* vShadingAttributes, const CVertexArrayLayout& vShadingLayout,
+	const void* vSkinAttributes, const CVertexArrayLayout& vSkinLayout, unsigned int vNumVertices)
 {
-	m_pVertexBuffer = std::make_shared<CVertexBuffer>(&m_Vertices[0], m_Vertices.size() * sizeof(SVertex));
-	m_pIndexBuffer = std::make_shared<CIndexBuffer>(&m_Indices[0], m_Indices.size());
+	m_pPositionBuffer = std::make_shared<CVertexBuffer>(vPositions, vNumVertices * vPositionLayout.getStride());
+	m_pShadingBuffer = std::make_shared<CVertexBuffer>(vShadingAttributes, vNumVertices * vShadingLayout.getStride());
+	if (m_HasSkin) m_pSkinBuffer = std::make_shared<CVertexBuffer>(vSkinAttributes, vNumVertices * vSkinLayout.getStride());
+
+	m_NumVertices = vNumVertices;
+	m_ShadingLayout = vShadingLayout;
+	m_VertexMemorySize = vNumVertices * (vPositionLayout.getStride() + vShadingLayout.getStride() + (m_HasSkin ? vSkinLayout.getStride() : 0));
+
+	const unsigned int SkinAttributeLocation = vPositionLayout.getNumElements() + vShadingLayout.getNumElements();
+	_ASSERTE(SkinAttributeLocation == BONE_ID_LOCATION);
+
 	m_pVertexArray = std::make_shared<CVertexArray>();
+	m_pVertexArray->addBuffer(*m_pPositionBuffer, vPositionLayout);
+	m_pVertexArray->addBuffer(*m_pShadingBuffer, vShadingLayout, vPositionLayout.getNumElements());
+	if (m_HasSkin) m_pVertexArray->addBuffer(*m_pSkinBuffer, vSkinLayout, SkinAttributeLocation);
+
+	m_pPositionVertexArray = std::make_shared<CVertexArray>();
+	m_pPositionVertexArray->addBuffer(*m_pPositionBuffer, vPositionLayout);
+	if (m_HasSkin) m_pPositionVertexArray->addBuffer(*m_pSkinBuffer, vSkinLayout, SkinAttributeLocation);
+
+	m_pPositionVertexArray->unbind();
+}
+
+//**********************************************************************************************
+//FUNCTION: indices stay relative to their part, so 16 bits are enough as long as every part has fewer than 65536 vertices
+void CMesh::__setupIndexBuffer(const unsigned int* vIndices, unsigned int vNumIndices, bool vUseShortIndices)
+{
+	if (vUseShortIndices)
+	{
+		std::vector<unsigned short> ShortIndices(vIndices, vIndices + vNumIndices);
+		m_pIndexBuffer = std::make_shared<CIndexBuffer>(ShortIndices.data(), vNumIndices);
+	}
+	else m_pIndexBuffer = std::make_shared<CIndexBuffer>(vIndices, vNumIndices);
+
+	m_IndexMemorySize = m_pIndexBuffer->getSize();
+}
+
+//**********************************************************************************************
+//FUNCTION: parts with the same textures and uniforms end up in one batch, which is submitted with a single multi-draw
+void CMesh::__setupDrawBatches(const std::vector<SMeshPart>& vParts, const std::vector<std::vector<std::pair<unsigned, unsigned>>>& vIndexRanges)
+{
+	const size_t IndexSize = m_pIndexBuffer->getSize() / std::max(m_pIndexBuffer->getCount(), 1u);
+
+	unsigned int BaseVertex = 0;
+	for (size_t i = 0; i < vParts.size(); ++i)
+	{
+		const SMeshPart& Part = vParts[i];
+		auto iter = std::find_if(m_DrawBatches.begin(), m_DrawBatches.end(), [&](const SDrawBatch& vBatch) { return __hasSameMaterial(vBatch, Part); });
+		if (iter == m_DrawBatches.end()) iter = m_DrawBatches.insert(m_DrawBatches.end(), SDrawBatch{ Part.Textures, Part.Uniforms, std::vector<SDrawRanges>(getNumLODs()) });
+
+		for (unsigned k = 0; k < getNumLODs(); ++k)
+		{
+			iter->LODs[k].Counts.push_back(static_cast<GLsizei>(vIndexRanges[i][k].second));
+			iter->LODs[k].Offsets.push_back(reinterpret_cast<const void*>(vIndexRanges[i][k].first * IndexSize));
+			iter->LODs[k].BaseVertices.push_back(static_cast<GLint>(BaseVertex));
+		}
+		iter->Parts.push_back(static_cast<unsigned>(i));
+
+		BaseVertex += Part.NumVertices;
+	}
+}
+
+//**********************************************************************************************
+//FUNCTION: the ranges of the parts of the batch that vPartVisibility (one entry per part) marks visible
+const CMesh::SDrawRanges& CMesh::__selectVisibleRanges(const SDrawBatch& vBatch, unsigned vLOD, const unsigned char* vPartVisibility) const
+{
+	const SDrawRanges& Ranges = vBatch.LODs[vLOD];
+	m_VisibleRanges.Counts.clear();
+	m_VisibleRanges.Offsets.clear();
+	m_VisibleRanges.BaseVertices.clear();
+	for (size_t i = 0; i < vBatch.Parts.size(); ++i)
+	{
+		if (!vPartVisibility[vBatch.Parts[i]]) continue;
+		m_VisibleRanges.Counts.push_back(Ranges.Counts[i]);
+		m_VisibleRanges.Offsets.push_back(Ranges.Offsets[i]);
+		m_VisibleRanges.BaseVertices.push_back(Ranges.BaseVertices[i]);
+	}
+
+	return m_VisibleRanges;
+}
+
+//**********************************************************************************************
+//FUNCTION:
+bool CMesh::__hasSameMaterial(const SDrawBatch& vBatch, const SMeshPart& vPart)
+{
+	if (vBatch.Textures.size() != vPart.Textures.size() || vBatch.Uniforms.size() != vPart.Uniforms.size()) return false;
+
+	for (size_t i = 0; i < vPart.Textures.size(); ++i)
+	{
+		if (vBatch.Textures[i].pTexture != vPart.Textures[i].pTexture || vBatch.Textures[i].UniformName != vPart.Textures[i].UniformName) return false;
+	}
+
+	for (size_t i = 0; i < vPart.Uniforms.size(); ++i)
+	{
+		const SUniformInfo& Left = vBatch.Uniforms[i];
+		const SUniformInfo& Right = vPart.Uniforms[i];
+		if (Left.Type != Right.Type || Left.Name != Right.Name) return false;
+
+		switch (Left.Type)
+		{
+		case EUniformType::FLOAT: if (std::any_cast<float>(Left.Value) != std::any_cast<float>(Right.Value)) return false; break;
+		case EUniformType::VEC2F: if (std::any_cast<glm::vec2>(Left.Value) != std::any_cast<glm::vec2>(Right.Value)) return false; break;
+		case EUniformType::VEC3F: if (std::any_cast<glm::vec3>(Left.Value) != std::any_cast<glm::vec3>(Right.Value)) return false; break;
+		case EUniformType::VEC4F: if (std::any_cast<glm::vec4>(Left.Value) != std::any_cast<glm::vec4>(Right.Value)) return false; break;
+		default: return false;
+		}
+	}
 
-	CVertexArrayLayout Layout;
-	Layout.push<float>(3);
-	Layout.push<float>(3);
-	Layout.push<float>(2);
-	Layout.push<int>(4);
-	Layout.push<float>(4);
-	m_pVertexArray->addBuffer(*m_pVertexBuffer, Layout);
+	return true;
+}
+
+//***********************************************************************************************
+//FUNCTION: the skinned vertices are unpacked floats, a position and a normal per vertex. The vertex array takes the
+//          texture coordinates from the shading buffer, whose normal at location 1 is then replaced by the skinned one
+void CMesh::_createSkinnedVertices(SSkinnedVertices& voSkinnedVertices) const
+{
+	_ASSERTE(m_HasSkin);
+
+	CVertexArrayLayout SkinnedLayout;
+	SkinnedLayout.push<float>(3);
+	SkinnedLayout.push<float>(3);
+
+	voSkinnedVertices.pBuffer = std::make_shared<CVertexBuffer>(nullptr, m_NumVertices * SkinnedLayout.getStride(), GL_DYNAMIC_COPY);
+	voSkinnedVertices.pVertexArray = std::make_shared<CVertexArray>();
+	voSkinnedVertices.pVertexArray->addBuffer(*m_pShadingBuffer, m_ShadingLayout, 1);
+	voSkinnedVertices.pVertexArray->addBuffer(*voSkinnedVertices.pBuffer, SkinnedLayout);
+	voSkinnedVertices.pVertexArray->unbind();
+}
+
+//***********************************************************************************************
+//FUNCTION: the skinning program has to be bound with the bone palette and uBoneOffset already set. The caller issues
+//          the vertex attribute barrier once after all meshes of the frame are skinned
+void CMesh::_skin(const CShaderProgram& vSkinningProgram, const SSkinnedVertices& vSkinnedVertices) const
+{
+	_ASSERTE(m_HasSkin && vSkinnedVertices.pBuffer);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SKINNING_POSITION_BINDING, m_pPositionBuffer->getObjectID());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SKINNING_SHADING_BINDING, m_pShadingBuffer->getObjectID());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SKINNING_SKIN_BINDING, m_pSkinBuffer->getObjectID());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SKINNED_VERTEX_BINDING, vSkinnedVertices.pBuffer->getObjectID());
+
+	vSkinningProgram.updateUniform1i("uNumVertices", static_cast<int>(m_NumVertices));
+	vSkinningProgram.updateUniform1i("uIsVertexPacked", m_IsVertexPacked);
+	if (m_IsVertexPacked)
+	{
+		vSkinningProgram.updateUniform3f("uPositionOffset", m_PositionOffset);
+		vSkinningProgram.updateUniform3f("uPositionScale", m_PositionScale);
+	}
+
+	glDispatchCompute((m_NumVertices + SKINNING_GROUP_SIZE - 1) / SKINNING_GROUP_SIZE, 1, 1);
+}
+
+//***********************************************************************************************
+//FUNCTION: the object ID of the first texture, meshes sharing it are drawn next to each other by a sorted command queue
+GLuint CMesh::getMaterialKey() const
+{
+	for (const auto& Batch : m_DrawBatches)
+		if (!Batch.Textures.empty()) return Batch.Textures.front().pTexture->getObjectID();
+	return 0;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+GLuint CMesh::getVertexArrayID(EVertexInput vVertexInput, const SSkinnedVertices* vSkinnedVertices) const
+{
+	return __selectVertexArray(vVertexInput, vSkinnedVertices).getObjectID();
 }
 
 //***********************************************************************************************
 //FUNCTION:
-void CMesh::_draw(const CShaderProgram& vShaderProgram) const
+const CVertexArray& CMesh::__selectVertexArray(EVertexInput vVertexInput, const SSkinnedVertices* vSkinnedVertices) const
+{
+	if (vSkinnedVertices && vSkinnedVertices->pVertexArray) return *vSkinnedVertices->pVertexArray;
+	return (vVertexInput == EVertexInput::PositionOnly) ? *m_pPositionVertexArray : *m_pVertexArray;
+}
+
+//***********************************************************************************************
+//FUNCTION: a mesh with skinned vertices is drawn from them like a static mesh, the shader must not skin it again. With
+//          several instances every range is drawn instanced, the shader tells the instances apart by gl_InstanceID. A merged
+//          mesh given vPartVisibility draws only the ranges of its visible parts and skips batches left without any
+void CMesh::_draw(const CShaderProgram& vShaderProgram, EVertexInput vVertexInput, unsigned vLOD, const SSkinnedVertices* vSkinnedVertices, unsigned vNumInstances,
+	SBindState* vioBindState, const unsigned char* vPartVisibility) const
 {
-	m_pVertexArray->bind();
-	m_pIndexBuffer->bind();
+	_ASSERTE(!vPartVisibility || !m_Parts.empty());
+	const unsigned LOD = std::min(vLOD, getNumLODs() - 1);
+	const bool IsPositionOnly = (vVertexInput == EVertexInput::PositionOnly);
+	const bool IsSkinned = vSkinnedVertices && vSkinnedVertices->pVertexArray;
+	const bool IsVertexPacked = m_IsVertexPacked && !IsSkinned;
+
+	const CVertexArray& VertexArray = __selectVertexArray(vVertexInput, vSkinnedVertices);
+	if (!vioBindState || vioBindState->changeVertexArray(VertexArray.getObjectID()))
+	{
+		VertexArray.bind();
+		m_pIndexBuffer->bind();
+	}
+
+	//NOTE: a mesh without skin has no bone attributes in its vertex array, so a skinning shader reads the current generic
+	//      values. Zero weights keep such a mesh, merged into a skinned model, in its bind pose
+	if (!m_HasSkin && !IsSkinned)
+	{
+		glVertexAttribI4i(BONE_ID_LOCATION, 0, 0, 0, 0);
+		glVertexAttrib4f(BONE_WEIGHT_LOCATION, 0.0f, 0.0f, 0.0f, 0.0f);
+	}
 
-	for (int i = 0; i < m_Textures.size(); ++i)
+	if (IsVertexPacked)
 	{
-		m_Textures[i]->bindV(i);
-		vShaderProgram.updateUniform1i(m_Textures[i]->getTextureName(), i);
+		vShaderProgram.updateUniform1i("uIsVertexPacked", true);
+		vShaderProgram.updateUniform3f("uPositionOffset", m_PositionOffset);
+		vShaderProgram.updateUniform3f("uPositionScale", m_PositionScale);
 	}
 
-	for (int i = 0; i < m_Uniforms.size(); ++i)
+	for (const auto& Batch : m_DrawBatches)
 	{
-		switch (m_Uniforms[i].Type)
+		const SDrawRanges& Ranges = vPartVisibility ? __selectVisibleRanges(Batch, LOD, vPartVisibility) : Batch.LODs[LOD];
+		if (Ranges.Counts.empty()) continue;
+
+		for (int i = 0; !IsPositionOnly && i < Batch.Textures.size(); ++i)
+		{
+			if (!vioBindState || vioBindState->changeTexture(i, Batch.Textures[i].pTexture->getObjectID())) Batch.Textures[i].pTexture->bindV(i);
+			vShaderProgram.updateUniform1i(Batch.Textures[i].UniformName, i);
+		}
+
+		for (int i = 0; !IsPositionOnly && i < Batch.Uniforms.size(); ++i)
 		{
-		case EUniformType::FLOAT:
-			vShaderProgram.updateUniform1f(m_Uniforms[i].Name, std::any_cast<float>(m_Uniforms[i].Value));
-			break;
-		case EUniformType::VEC2F:
-			vShaderProgram.updateUniform2f(m_Uniforms[i].Name, std::any_cast<glm::vec2>(m_Uniforms[i].Value));
-			break;
-		case EUniformType::VEC3F:
-			vShaderProgram.updateUniform3f(m_Uniforms[i].Name, std::any_cast<glm::vec3>(m_Uniforms[i].Value));
-			break;
-		case EUniformType::VEC4F:
-			vShaderProgram.updateUniform4f(m_Uniforms[i].Name, std::any_cast<glm::vec4>(m_Uniforms[i].Value));
-			break;
-		default:
-			_OUTPUT_WARNING("The uniform type is not supported.");
-			break;
+			switch (Batch.Uniforms[i].Type)
+			{
+			case EUniformType::FLOAT:
+				vShaderProgram.updateUniform1f(Batch.Uniforms[i].Name, std::any_cast<float>(Batch.Uniforms[i].Value));
+				break;
+			case EUniformType::VEC2F:
+				vShaderProgram.updateUniform2f(Batch.Uniforms[i].Name, std::any_cast<glm::vec2>(Batch.Uniforms[i].Value));
+				break;
+			case EUniformType::VEC3F:
+				vShaderProgram.updateUniform3f(Batch.Uniforms[i].Name, std::any_cast<glm::vec3>(Batch.Uniforms[i].Value));
+				break;
+			case EUniformType::VEC4F:
+				vShaderProgram.updateUniform4f(Batch.Uniforms[i].Name, std::any_cast<glm::vec4>(Batch.Uniforms[i].Value));
+				break;
+			default:
+				_OUTPUT_WARNING("The uniform type is not supported.");
+				break;
+			}
 		}
+
+		if (vNumInstances != 1)
+		{
+			for (size_t i = 0; i < Ranges.Counts.size(); ++i)
+				glDrawElementsInstancedBaseVertex(GL_TRIANGLES, Ranges.Counts[i], m_pIndexBuffer->getType(), Ranges.Offsets[i], static_cast<GLsizei>(vNumInstances), Ranges.BaseVertices[i]);
+		}
+		else if (Ranges.Counts.size() == 1)
+			glDrawElementsBaseVertex(GL_TRIANGLES, Ranges.Counts[0], m_pIndexBuffer->getType(), Ranges.Offsets[0], Ranges.BaseVertices[0]);
+		else
+			glMultiDrawElementsBaseVertex(GL_TRIANGLES, Ranges.Counts.data(), m_pIndexBuffer->getType(), Ranges.Offsets.data(), static_cast<GLsizei>(Ranges.Counts.size()), Ranges.BaseVertices.data());
 	}
 
-	glDrawElements(GL_TRIANGLES, m_pIndexBuffer->getCount(), GL_UNSIGNED_INT, nullptr);
+	if (IsVertexPacked) vShaderProgram.updateUniform1i("uIsVertexPacked", false);
 
 #ifdef _DEBUG
+	if (vioBindState) return;
+
 	m_pVertexArray->unbind();
-	m_pVertexBuffer->unbind();
+	m_pPositionBuffer->unbind();
 
-	for (GLuint i = 0; i < m_Textures.size(); i++)
+	for (const auto& Batch : m_DrawBatches)
 	{
-		m_Textures[i]->unbindV();
+		for (GLuint i = 0; !IsPositionOnly && i < Batch.Textures.size(); i++)
+		{
+			Batch.Textures[i].pTexture->unbindV();
+		}
 	}
 #endif
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include <any>
 #include <glm/glm.hpp>
 #include <assimp/Importer.hpp>
@@ -30,37 +31,209 @@ namespace glt
 	{
 		glm::vec3 Min;
 		glm::vec3 Max;
+
+		//NOTE: the smallest box around the transformed box, which also holds for rotations and non-uniform scaling
+		SAABB transform(const glm::mat4& vMatrix) const
+		{
+			glm::vec3 Center = glm::vec3(vMatrix * glm::vec4(0.5f * (Min + Max), 1.0f));
+			glm::vec3 HalfExtent = 0.5f * (Max - Min);
+			glm::vec3 TransformedHalfExtent = glm::abs(glm::vec3(vMatrix[0])) * HalfExtent.x + glm::abs(glm::vec3(vMatrix[1])) * HalfExtent.y
+				+ glm::abs(glm::vec3(vMatrix[2])) * HalfExtent.z;
+			return SAABB{ Center - TransformedHalfExtent, Center + TransformedHalfExtent };
+		}
+	};
+
+	struct STextureInfo
+	{
+		std::string Name;
+		std::string FilePath;
+	};
+
+	struct SMeshData
+	{
+		std::vector<SVertex> Vertices;
+		std::vector<unsigned int> Indices;
+		std::vector<std::vector<unsigned int>> LODs;
+		std::vector<STextureInfo> Textures;
+		std::vector<SUniformInfo> Uniforms;
+		SAABB AABB;
+	};
+
+	enum class EVertexInput : unsigned char
+	{
+		Full = 0,
+		PositionOnly
 	};
 
 	class CShaderProgram;
 	class CTexture2D;
 
+	struct SMeshTexture
+	{
+		std::string UniformName;
+		std::shared_ptr<CTexture2D> pTexture;
+	};
+
+	struct SMeshLOD
+	{
+		const unsigned int* pIndices = nullptr;
+		unsigned NumIndices = 0;
+	};
+
+	//NOTE: one skinned mesh of one model instance after the pre-skinning pass, the skinned positions and normals replace
+	//      the source streams while the texture coordinates are still read from the mesh
+	struct SSkinnedVertices
+	{
+		std::shared_ptr<CVertexBuffer> pBuffer;
+		std::shared_ptr<CVertexArray> pVertexArray;
+	};
+
+	//NOTE: the objects bound through the renderer. Every program is bound through it, so Program is always the current
+	//      one. Vertex arrays and textures are also bound by GL calls elsewhere, reset() forgets them and 0 stands for
+	//      unknown. A bind of what is already bound is skipped, binds that reach GL and binds skipped are counted
+	struct SBindState
+	{
+		GLuint Program = 0;
+		GLuint VertexArray = 0;
+		std::vector<GLuint> Textures;
+
+		unsigned NumProgramBinds = 0;
+		unsigned NumVertexArrayBinds = 0;
+		unsigned NumTextureBinds = 0;
+		unsigned NumElidedBinds = 0;
+
+		void reset() { VertexArray = 0; Textures.clear(); }
+
+		bool changeProgram(GLuint vProgram)
+		{
+			if (vProgram == Program) { NumElidedBinds++; return false; }
+			Program = vProgram;
+			NumProgramBinds++;
+			return true;
+		}
+
+		bool changeVertexArray(GLuint vVertexArray)
+		{
+			if (vVertexArray == VertexArray) { NumElidedBinds++; return false; }
+			VertexArray = vVertexArray;
+			NumVertexArrayBinds++;
+			return true;
+		}
+
+		bool changeTexture(unsigned vBindPoint, GLuint vTexture)
+		{
+			if (vBindPoint >= Textures.size()) Textures.resize(vBindPoint + 1, 0);
+			if (vTexture == Textures[vBindPoint]) { NumElidedBinds++; return false; }
+			Textures[vBindPoint] = vTexture;
+			NumTextureBinds++;
+			return true;
+		}
+	};
+
+	struct SMeshPart
+	{
+		const SVertex* pVertices = nullptr;
+		unsigned NumVertices = 0;
+		const unsigned int* pIndices = nullptr;
+		unsigned NumIndices = 0;
+		std::vector<SMeshTexture> Textures;
+		std::vector<SUniformInfo> Uniforms;
+		SAABB AABB;
+		std::vector<SMeshLOD> LODs;
+	};
+
 	class CMesh
 	{
 	public:
 		CMesh(const std::vector<SVertex>& vVertices, const std::vector<unsigned int>& vIndices, const std::vector<std::shared_ptr<CTexture2D>>& vTextures,
 			const std::vector<SUniformInfo>& vUniforms, const SAABB& vAABB);
+		CMesh(const SVertex* vVertices, unsigned int vNumVertices, const unsigned int* vIndices, unsigned int vNumIndices, const std::vector<std::shared_ptr<CTexture2D>>& vTextures,
+			const std::vector<SUniformInfo>& vUniforms, const SAABB& vAABB, bool vPackVertices = false);
+		CMesh(const std::vector<SMeshPart>& vParts, bool vPackVertices = false);
 
 		const SAABB& getAABB() const { return m_AABB; }
+		bool isVertexPacked() const { return m_IsVertexPacked; }
+		bool hasSkin() const { return m_HasSkin; }
+		unsigned getNumVertices() const { return m_NumVertices; }
+		size_t getVertexMemorySize() const { return m_VertexMemorySize; }
+		size_t getIndexMemorySize() const { return m_IndexMemorySize; }
+		unsigned getNumDrawCalls() const { return static_cast<unsigned>(m_DrawBatches.size()); }
+		unsigned getNumLODs() const { return static_cast<unsigned>(m_NumTrianglesPerLOD.size()); }
+		unsigned getNumTriangles(unsigned vLOD = 0) const { return m_NumTrianglesPerLOD[std::min(vLOD, getNumLODs() - 1)]; }
+		unsigned getNumParts() const { return static_cast<unsigned>(m_Parts.size()); }
+		const SAABB& getPartAABB(unsigned vPart) const { _ASSERTE(vPart < m_Parts.size()); return m_Parts[vPart].AABB; }
+		unsigned getNumPartTriangles(unsigned vPart, unsigned vLOD = 0) const { _ASSERTE(vPart < m_Parts.size()); return m_Parts[vPart].NumTrianglesPerLOD[std::min(vLOD, getNumLODs() - 1)]; }
+		GLuint getMaterialKey() const;
+		GLuint getVertexArrayID(EVertexInput vVertexInput = EVertexInput::Full, const SSkinnedVertices* vSkinnedVertices = nullptr) const;
 
 	protected:
-		void _draw(const CShaderProgram& vShaderProgram) const;
+		void _draw(const CShaderProgram& vShaderProgram, EVertexInput vVertexInput = EVertexInput::Full, unsigned vLOD = 0, const SSkinnedVertices* vSkinnedVertices = nullptr,
+			unsigned vNumInstances = 1, SBindState* vioBindState = nullptr, const unsigned char* vPartVisibility = nullptr) const;
+		void _createSkinnedVertices(SSkinnedVertices& voSkinnedVertices) const;
+		void _skin(const CShaderProgram& vSkinningProgram, const SSkinnedVertices& vSkinnedVertices) const;
 
 	private:
-		void __setupMesh();
+		struct SDrawRanges
+		{
+			std::vector<GLsizei> Counts;
+			std::vector<const void*> Offsets;
+			std::vector<GLint> BaseVertices;
+		};
+
+		//NOTE: Parts[i] is the part drawn by the i-th range of every level
+		struct SDrawBatch
+		{
+			std::vector<SMeshTexture> Textures;
+			std::vector<SUniformInfo> Uniforms;
+			std::vector<SDrawRanges> LODs;
+			std::vector<unsigned> Parts;
+		};
+
+		struct SPart
+		{
+			SAABB AABB;
+			std::vector<unsigned> NumTrianglesPerLOD;
+		};
+
+		void __setupMesh(const SVertex* vVertices, unsigned int vNumVertices);
+		void __setupPackedMesh(const SVertex* vVertices, unsigned int vNumVertices);
+		void __setupVertexArrays(const void* vPositions, const CVertexArrayLayout& vPositionLayout, const void* vShadingAttributes, const CVertexArrayLayout& vShadingLayout,
+			const void* vSkinAttributes, const CVertexArrayLayout& vSkinLayout, unsigned int vNumVertices);
+		void __setupIndexBuffer(const unsigned int* vIndices, unsigned int vNumIndices, bool vUseShortIndices);
+		const CVertexArray& __selectVertexArray(EVertexInput vVertexInput, const SSkinnedVertices* vSkinnedVertices) const;
+		void __setupDrawBatches(const std::vector<SMeshPart>& vParts, const std::vector<std::vector<std::pair<unsigned, unsigned>>>& vIndexRanges);
+
+		const SDrawRanges& __selectVisibleRanges(const SDrawBatch& vBatch, unsigned vLOD, const unsigned char* vPartVisibility) const;
+
+		static bool __hasSameMaterial(const SDrawBatch& vBatch, const SMeshPart& vPart);
 
 	private:
-		std::vector<SVertex> m_Vertices;
-		std::vector<GLuint> m_Indices;
-		std::vector<std::shared_ptr<CTexture2D>> m_Textures;
-		std::vector<SUniformInfo> m_Uniforms;
+		std::vector<SDrawBatch> m_DrawBatches;
+		std::vector<unsigned> m_NumTrianglesPerLOD;
+
+		//NOTE: the parts a merged mesh was built from, so that they can be culled one by one. A mesh of a single part has none
+		std::vector<SPart> m_Parts;
+		mutable SDrawRanges m_VisibleRanges;
 
-		std::shared_ptr<CVertexBuffer>	m_pVertexBuffer;
+		std::shared_ptr<CVertexBuffer>	m_pPositionBuffer;
+		std::shared_ptr<CVertexBuffer>	m_pShadingBuffer;
+		std::shared_ptr<CVertexBuffer>	m_pSkinBuffer;
 		std::shared_ptr<CIndexBuffer>	m_pIndexBuffer;
 		std::shared_ptr<CVertexArray>	m_pVertexArray;
+		std::shared_ptr<CVertexArray>	m_pPositionVertexArray;
+
+		CVertexArrayLayout				m_ShadingLayout;
 
 		SAABB m_AABB;
 
-		friend class CModel;
+		unsigned m_NumVertices = 0;
+		bool m_HasSkin = false;
+		bool m_IsVertexPacked = false;
+		glm::vec3 m_PositionOffset = glm::vec3(0.0f);
+		glm::vec3 m_PositionScale = glm::vec3(1.0f);
+		size_t m_VertexMemorySize = 0;
+		size_t m_IndexMemorySize = 0;
+
+		friend class CModelAsset;
 	};
 }
\ No newline at end of file
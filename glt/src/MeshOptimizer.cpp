@@ -0,0 +1,325 @@
+#include "MeshOptimizer.h"
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cstring>
+#include <cmath>
+
+using namespace glt;
+
+namespace
+{
+	constexpr unsigned SCORING_CACHE_SIZE = 32;
+	constexpr float CACHE_DECAY_POWER = 1.5f;
+	constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+	constexpr float VALENCE_BOOST_SCALE = 2.0f;
+	constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+	struct SVertexHasher
+	{
+		const SVertex* pVertices = nullptr;
+
+		size_t operator()(unsigned vIndex) const
+		{
+			const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(pVertices + vIndex);
+			size_t Hash = 14695981039346656037ull;
+			for (size_t i = 0; i < sizeof(SVertex); ++i) Hash = (Hash ^ pBytes[i]) * 1099511628211ull;
+			return Hash;
+		}
+	};
+
+	struct SVertexEqual
+	{
+		const SVertex* pVertices = nullptr;
+
+		bool operator()(unsigned vLeft, unsigned vRight) const { return std::memcmp(pVertices + vLeft, pVertices + vRight, sizeof(SVertex)) == 0; }
+	};
+
+	//NOTE: a FIFO post-transform cache, a vertex is still cached if fewer than CacheSize misses happened since it was loaded
+	class CFifoCacheSimulator
+	{
+	public:
+		CFifoCacheSimulator(unsigned vNumVertices, unsigned vCacheSize) : m_Timestamps(vNumVertices, 0), m_CacheSize(vCacheSize), m_Time(vCacheSize + 1) {}
+
+		bool access(unsigned vVertex)
+		{
+			if (m_Time - m_Timestamps[vVertex] <= m_CacheSize) return true;
+			m_Timestamps[vVertex] = m_Time++;
+			return false;
+		}
+
+	private:
+		std::vector<unsigned> m_Timestamps;
+		unsigned m_CacheSize = 0;
+		unsigned m_Time = 0;
+	};
+
+	struct STriangleCluster
+	{
+		unsigned FirstTriangle = 0;
+		unsigned NumTriangles = 0;
+		float SortKey = 0.0f;
+	};
+}
+
+//***********************************************************************************************
+//FUNCTION: score of a vertex in Forsyth's linear-speed vertex cache optimization
+static float __computeVertexScore(int vCachePosition, unsigned vNumRemainingTriangles)
+{
+	if (vNumRemainingTriangles == 0) return -1.0f;
+
+	float Score = 0.0f;
+	if (vCachePosition >= 0)
+	{
+		if (vCachePosition < 3) Score = LAST_TRIANGLE_SCORE;
+		else Score = std::pow(1.0f - (vCachePosition - 3) / static_cast<float>(SCORING_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+	}
+
+	return Score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(vNumRemainingTriangles), -VALENCE_BOOST_POWER);
+}
+
+//***********************************************************************************************
+//FUNCTION:
+void CMeshOptimizer::optimize(SMeshData& vioMesh, bool vOptimizeOverdraw)
+{
+	weldVertices(vioMesh.Vertices, vioMesh.Indices);
+	optimizeVertexCache(vioMesh.Indices, static_cast<unsigned>(vioMesh.Vertices.size()));
+	if (vOptimizeOverdraw) optimizeOverdraw(vioMesh.Indices, vioMesh.Vertices);
+	optimizeVertexFetch(vioMesh.Vertices, vioMesh.Indices);
+}
+
+//***********************************************************************************************
+//FUNCTION: vertices are compared bitwise, so two vertices are only merged if every attribute (skin included) matches
+void CMeshOptimizer::weldVertices(std::vector<SVertex>& vioVertices, std::vector<unsigned int>& vioIndices)
+{
+	const SVertex* pVertices = vioVertices.data();
+	std::unordered_map<unsigned, unsigned, SVertexHasher, SVertexEqual> UniqueVertexMap(vioVertices.size(), SVertexHasher{ pVertices }, SVertexEqual{ pVertices });
+
+	std::vector<unsigned> Remap(vioVertices.size());
+	std::vector<SVertex> WeldedVertices;
+	WeldedVertices.reserve(vioVertices.size());
+
+	for (unsigned i = 0; i < vioVertices.size(); ++i)
+	{
+		auto Result = UniqueVertexMap.emplace(i, static_cast<unsigned>(WeldedVertices.size()));
+		if (Result.second) WeldedVertices.push_back(vioVertices[i]);
+		Remap[i] = Result.first->second;
+	}
+
+	for (auto& Index : vioIndices) Index = Remap[Index];
+	vioVertices.swap(WeldedVertices);
+}
+
+//***********************************************************************************************
+//FUNCTION: greedily emits the triangle with the highest score, only the triangles around the vertices in the
+//          simulated LRU cache are rescored after each step
+void CMeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& vioIndices, unsigned vNumVertices)
+{
+	const unsigned NumTriangles = static_cast<unsigned>(vioIndices.size() / 3);
+	if (NumTriangles < 2) return;
+
+	std::vector<unsigned> NumRemainingTriangles(vNumVertices, 0);
+	for (auto Index : vioIndices) ++NumRemainingTriangles[Index];
+
+	std::vector<unsigned> AdjacencyOffsets(vNumVertices + 1, 0);
+	std::partial_sum(NumRemainingTriangles.begin(), NumRemainingTriangles.end(), AdjacencyOffsets.begin() + 1);
+
+	std::vector<unsigned> AdjacentTriangles(vioIndices.size());
+	std::vector<unsigned> FillOffsets(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+	for (unsigned i = 0; i < vioIndices.size(); ++i) AdjacentTriangles[FillOffsets[vioIndices[i]]++] = i / 3;
+
+	std::vector<int> CachePositions(vNumVertices, -1);
+	std::vector<float> VertexScores(vNumVertices);
+	for (unsigned i = 0; i < vNumVertices; ++i) VertexScores[i] = __computeVertexScore(-1, NumRemainingTriangles[i]);
+
+	std::vector<float> TriangleScores(NumTriangles);
+	for (unsigned i = 0; i < NumTriangles; ++i)
+		TriangleScores[i] = VertexScores[vioIndices[3 * i]] + VertexScores[vioIndices[3 * i + 1]] + VertexScores[vioIndices[3 * i + 2]];
+
+	std::vector<bool> IsEmitted(NumTriangles, false);
+	std::vector<unsigned> Cache, NewCache;
+	Cache.reserve(SCORING_CACHE_SIZE + 3);
+	NewCache.reserve(SCORING_CACHE_SIZE + 3);
+
+	std::vector<unsigned> OptimizedIndices;
+	OptimizedIndices.reserve(vioIndices.size());
+
+	int BestTriangle = static_cast<int>(std::max_element(TriangleScores.begin(), TriangleScores.end()) - TriangleScores.begin());
+	unsigned SearchCursor = 0;
+
+	for (unsigned n = 0; n < NumTriangles; ++n)
+	{
+		if (BestTriangle < 0)
+		{
+			while (IsEmitted[SearchCursor]) ++SearchCursor;
+			BestTriangle = static_cast<int>(SearchCursor);
+		}
+
+		const unsigned* pTriangle = &vioIndices[3 * BestTriangle];
+		OptimizedIndices.insert(OptimizedIndices.end(), pTriangle, pTriangle + 3);
+		IsEmitted[BestTriangle] = true;
+
+		NewCache.clear();
+		for (int k = 0; k < 3; ++k)
+		{
+			unsigned Vertex = pTriangle[k];
+			unsigned* pBegin = &AdjacentTriangles[AdjacencyOffsets[Vertex]];
+			unsigned* pEnd = pBegin + NumRemainingTriangles[Vertex];
+			unsigned* pFound = std::find(pBegin, pEnd, static_cast<unsigned>(BestTriangle));
+			_ASSERTE(pFound != pEnd);
+			std::swap(*pFound, *(pEnd - 1));
+			--NumRemainingTriangles[Vertex];
+
+			if (std::find(NewCache.begin(), NewCache.end(), Vertex) == NewCache.end()) NewCache.push_back(Vertex);
+		}
+		for (auto Vertex : Cache)
+		{
+			if (std::find(NewCache.begin(), NewCache.end(), Vertex) == NewCache.end()) NewCache.push_back(Vertex);
+		}
+
+		for (unsigned i = 0; i < NewCache.size(); ++i)
+		{
+			unsigned Vertex = NewCache[i];
+			CachePositions[Vertex] = (i < SCORING_CACHE_SIZE) ? static_cast<int>(i) : -1;
+			VertexScores[Vertex] = __computeVertexScore(CachePositions[Vertex], NumRemainingTriangles[Vertex]);
+		}
+
+		BestTriangle = -1;
+		float BestScore = -std::numeric_limits<float>::max();
+		for (auto Vertex : NewCache)
+		{
+			for (unsigned i = 0; i < NumRemainingTriangles[Vertex]; ++i)
+			{
+				unsigned Triangle = AdjacentTriangles[AdjacencyOffsets[Vertex] + i];
+				float Score = VertexScores[vioIndices[3 * Triangle]] + VertexScores[vioIndices[3 * Triangle + 1]] + VertexScores[vioIndices[3 * Triangle + 2]];
+				TriangleScores[Triangle] = Score;
+				if (Score > BestScore) { BestScore = Score; BestTriangle = static_cast<int>(Triangle); }
+			}
+		}
+
+		if (NewCache.size() > SCORING_CACHE_SIZE) NewCache.resize(SCORING_CACHE_SIZE);
+		Cache.swap(NewCache);
+	}
+
+	vioIndices.swap(OptimizedIndices);
+}
+
+//***********************************************************************************************
+//FUNCTION: a simplified version of Sander et al.'s "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+//          The cache optimized list is split where a triangle misses all three vertices, so moving the clusters around
+//          barely changes the ACMR, and clusters facing away from the mesh center are drawn first
+void CMeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& vioIndices, const std::vector<SVertex>& vVertices, float vThreshold)
+{
+	const unsigned NumTriangles = static_cast<unsigned>(vioIndices.size() / 3);
+	if (NumTriangles < 2) return;
+
+	const unsigned NumVertices = static_cast<unsigned>(vVertices.size());
+	const unsigned NumOriginalMisses = countCacheMisses(vioIndices, NumVertices);
+
+	std::vector<STriangleCluster> Clusters;
+	CFifoCacheSimulator Cache(NumVertices, 16);
+	for (unsigned i = 0; i < NumTriangles; ++i)
+	{
+		int NumMisses = 0;
+		for (int k = 0; k < 3; ++k) NumMisses += Cache.access(vioIndices[3 * i + k]) ? 0 : 1;
+
+		if (Clusters.empty() || NumMisses == 3) Clusters.push_back(STriangleCluster{ i, 0, 0.0f });
+		++Clusters.back().NumTriangles;
+	}
+	if (Clusters.size() < 2) return;
+
+	glm::vec3 MeshCenter(0.0f);
+	float MeshArea = 0.0f;
+	std::vector<glm::vec3> ClusterCenters(Clusters.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> ClusterNormals(Clusters.size(), glm::vec3(0.0f));
+	for (unsigned i = 0; i < Clusters.size(); ++i)
+	{
+		float ClusterArea = 0.0f;
+		for (unsigned t = Clusters[i].FirstTriangle; t < Clusters[i].FirstTriangle + Clusters[i].NumTriangles; ++t)
+		{
+			const glm::vec3& A = vVertices[vioIndices[3 * t]].Position;
+			const glm::vec3& B = vVertices[vioIndices[3 * t + 1]].Position;
+			const glm::vec3& C = vVertices[vioIndices[3 * t + 2]].Position;
+
+			glm::vec3 Normal = glm::cross(B - A, C - A);
+			float Area = glm::length(Normal);
+			ClusterCenters[i] += (A + B + C) * (Area / 3.0f);
+			ClusterNormals[i] += Normal;
+			ClusterArea += Area;
+		}
+
+		MeshCenter += ClusterCenters[i];
+		MeshArea += ClusterArea;
+		if (ClusterArea > 0.0f) ClusterCenters[i] /= ClusterArea;
+	}
+	if (MeshArea > 0.0f) MeshCenter /= MeshArea;
+
+	for (unsigned i = 0; i < Clusters.size(); ++i)
+	{
+		float NormalLength = glm::length(ClusterNormals[i]);
+		Clusters[i].SortKey = (NormalLength > 0.0f) ? glm::dot(ClusterCenters[i] - MeshCenter, ClusterNormals[i] / NormalLength) : 0.0f;
+	}
+
+	std::stable_sort(Clusters.begin(), Clusters.end(), [](const STriangleCluster& vLeft, const STriangleCluster& vRight) { return vLeft.SortKey > vRight.SortKey; });
+
+	std::vector<unsigned> SortedIndices;
+	SortedIndices.reserve(vioIndices.size());
+	for (const auto& Cluster : Clusters)
+	{
+		auto Begin = vioIndices.begin() + 3 * Cluster.FirstTriangle;
+		SortedIndices.insert(SortedIndices.end(), Begin, Begin + 3 * Cluster.NumTriangles);
+	}
+
+	if (countCacheMisses(SortedIndices, NumVertices) <= NumOriginalMisses * vThreshold) vioIndices.swap(SortedIndices);
+}
+
+//***********************************************************************************************
+//FUNCTION: vertices are renumbered in the order they are first referenced, unreferenced vertices are dropped
+void CMeshOptimizer::optimizeVertexFetch(std::vector<SVertex>& vioVertices, std::vector<unsigned int>& vioIndices)
+{
+	const unsigned Unassigned = std::numeric_limits<unsigned>::max();
+	std::vector<unsigned> Remap(vioVertices.size(), Unassigned);
+
+	std::vector<SVertex> OrderedVertices;
+	OrderedVertices.reserve(vioVertices.size());
+
+	for (auto& Index : vioIndices)
+	{
+		if (Remap[Index] == Unassigned)
+		{
+			Remap[Index] = static_cast<unsigned>(OrderedVertices.size());
+			OrderedVertices.push_back(vioVertices[Index]);
+		}
+		Index = Remap[Index];
+	}
+
+	vioVertices.swap(OrderedVertices);
+}
+
+//***********************************************************************************************
+//FUNCTION:
+unsigned CMeshOptimizer::countCacheMisses(const std::vector<unsigned int>& vIndices, unsigned vNumVertices, unsigned vCacheSize)
+{
+	CFifoCacheSimulator Cache(vNumVertices, vCacheSize);
+
+	unsigned NumMisses = 0;
+	for (auto Index : vIndices) NumMisses += Cache.access(Index) ? 0 : 1;
+	return NumMisses;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+SMeshStatistics CMeshOptimizer::analyze(const SMeshData& vMesh, bool vUse16BitIndices)
+{
+	SMeshStatistics Statistics;
+	Statistics.NumVertices = static_cast<unsigned>(vMesh.Vertices.size());
+	Statistics.NumIndices = static_cast<unsigned>(vMesh.Indices.size());
+	Statistics.NumCacheMisses = countCacheMisses(vMesh.Indices, Statistics.NumVertices);
+	Statistics.VertexMemorySize = vMesh.Vertices.size() * sizeof(SVertex);
+
+	bool Is16Bit = vUse16BitIndices && CIndexBuffer::canUseShortIndices(Statistics.NumVertices);
+	Statistics.IndexMemorySize = vMesh.Indices.size() * (Is16Bit ? sizeof(unsigned short) : sizeof(unsigned int));
+
+	return Statistics;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include "Mesh.h"
+#include "Export.h"
+
+namespace glt
+{
+	struct SMeshStatistics
+	{
+		unsigned NumVertices = 0;
+		unsigned NumIndices = 0;
+		unsigned NumCacheMisses = 0;
+		size_t VertexMemorySize = 0;
+		size_t IndexMemorySize = 0;
+
+		float getACMR() const { return NumIndices ? 3.0f * NumCacheMisses / NumIndices : 0.0f; }
+
+		SMeshStatistics& operator+=(const SMeshStatistics& vOther)
+		{
+			NumVertices += vOther.NumVertices;
+			NumIndices += vOther.NumIndices;
+			NumCacheMisses += vOther.NumCacheMisses;
+			VertexMemorySize += vOther.VertexMemorySize;
+			IndexMemorySize += vOther.IndexMemorySize;
+			return *this;
+		}
+	};
+
+	//NOTE: all stages keep the triangle list valid on their own, they are run in the order
+	//      weld -> vertex cache -> overdraw -> vertex fetch by optimize()
+	class GLT_DECLSPEC CMeshOptimizer
+	{
+	public:
+		static void optimize(SMeshData& vioMesh, bool vOptimizeOverdraw);
+
+		static void weldVertices(std::vector<SVertex>& vioVertices, std::vector<unsigned int>& vioIndices);
+		static void optimizeVertexCache(std::vector<unsigned int>& vioIndices, unsigned vNumVertices);
+		static void optimizeOverdraw(std::vector<unsigned int>& vioIndices, const std::vector<SVertex>& vVertices, float vThreshold = 1.05f);
+		static void optimizeVertexFetch(std::vector<SVertex>& vioVertices, std::vector<unsigned int>& vioIndices);
+
+		static unsigned countCacheMisses(const std::vector<unsigned int>& vIndices, unsigned vNumVertices, unsigned vCacheSize = 16);
+		static SMeshStatistics analyze(const SMeshData& vMesh, bool vUse16BitIndices);
+
+	private:
+		CMeshOptimizer() = delete;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <unordered_map>
+#include <cfloat>
+#include "MeshOptimizer.h"
+
+using namespace glt;
+
+namespace
+{
+	struct SQuadric
+	{
+		double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+		double b0 = 0, b1 = 0, b2 = 0, c = 0;
+
+		void addPlane(const glm::dvec3& vNormal, double vDistance, double vWeight)
+		{
+			a00 += vWeight * vNormal.x * vNormal.x; a01 += vWeight * vNormal.x * vNormal.y; a02 += vWeight * vNormal.x * vNormal.z;
+			a11 += vWeight * vNormal.y * vNormal.y; a12 += vWeight * vNormal.y * vNormal.z; a22 += vWeight * vNormal.z * vNormal.z;
+			b0 += vWeight * vNormal.x * vDistance; b1 += vWeight * vNormal.y * vDistance; b2 += vWeight * vNormal.z * vDistance;
+			c += vWeight * vDistance * vDistance;
+		}
+
+		void add(const SQuadric& vOther)
+		{
+			a00 += vOther.a00; a01 += vOther.a01; a02 += vOther.a02; a11 += vOther.a11; a12 += vOther.a12; a22 += vOther.a22;
+			b0 += vOther.b0; b1 += vOther.b1; b2 += vOther.b2; c += vOther.c;
+		}
+
+		double evaluate(const glm::vec3& vPoint) const
+		{
+			double x = vPoint.x, y = vPoint.y, z = vPoint.z;
+			double Error = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + a11 * y * y + 2 * a12 * y * z + a22 * z * z + 2 * (b0 * x + b1 * y + b2 * z) + c;
+			return std::max(Error, 0.0);
+		}
+	};
+
+	struct SCollapse
+	{
+		unsigned Source = 0;
+		unsigned Target = 0;
+		double Error = 0.0;
+	};
+}
+
+//***********************************************************************************************
+//FUNCTION: an edge used by a single triangle is an open edge, in the welded index buffer these are the mesh borders and seams
+static std::vector<bool> __findLockedVertices(const std::vector<unsigned int>& vIndices, unsigned vNumVertices)
+{
+	std::unordered_map<unsigned long long, int> EdgeCounts;
+	EdgeCounts.reserve(vIndices.size());
+	for (size_t i = 0; i < vIndices.size(); i += 3)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			unsigned long long A = vIndices[i + k], B = vIndices[i + (k + 1) % 3];
+			if (A > B) std::swap(A, B);
+			EdgeCounts[(A << 32) | B]++;
+		}
+	}
+
+	std::vector<bool> IsLocked(vNumVertices, false);
+	for (const auto& Pair : EdgeCounts)
+	{
+		if (Pair.second != 1) continue;
+		IsLocked[static_cast<unsigned>(Pair.first >> 32)] = true;
+		IsLocked[static_cast<unsigned>(Pair.first & 0xffffffffull)] = true;
+	}
+	return IsLocked;
+}
+
+//***********************************************************************************************
+//FUNCTION: moving vSource onto vTarget must not flip any of the remaining triangles around vSource
+static bool __isCollapseValid(const std::vector<SVertex>& vVertices, const std::vector<unsigned int>& vIndices, const std::vector<unsigned>& vAdjacentTriangles, unsigned vSource, unsigned vTarget)
+{
+	const glm::vec3& Target = vVertices[vTarget].Position;
+	for (auto Triangle : vAdjacentTriangles)
+	{
+		const unsigned* pCorners = &vIndices[3 * Triangle];
+		if (pCorners[0] == vTarget || pCorners[1] == vTarget || pCorners[2] == vTarget) continue;
+
+		glm::vec3 Before[3], After[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			Before[k] = vVertices[pCorners[k]].Position;
+			After[k] = (pCorners[k] == vSource) ? Target : Before[k];
+		}
+
+		glm::vec3 NormalBefore = glm::cross(Before[1] - Before[0], Before[2] - Before[0]);
+		glm::vec3 NormalAfter = glm::cross(After[1] - After[0], After[2] - After[0]);
+		if (glm::dot(NormalBefore, NormalAfter) <= 0.0f) return false;
+	}
+	return true;
+}
+
+//***********************************************************************************************
+//FUNCTION: runs passes of non-overlapping collapses (cheapest first) until the target index count or error is reached
+void CMeshSimplifier::simplify(const std::vector<SVertex>& vVertices, const std::vector<unsigned int>& vIndices, unsigned vTargetNumIndices, float vTargetError, std::vector<unsigned int>& voIndices)
+{
+	voIndices = vIndices;
+	const unsigned NumVertices = static_cast<unsigned>(vVertices.size());
+	if (voIndices.size() <= vTargetNumIndices || NumVertices == 0) return;
+
+	glm::vec3 Min(FLT_MAX), Max(-FLT_MAX);
+	for (const auto& Vertex : vVertices) { Min = glm::min(Min, Vertex.Position); Max = glm::max(Max, Vertex.Position); }
+	const double MaxError = std::pow(static_cast<double>(vTargetError) * glm::length(Max - Min), 2.0);
+
+	const std::vector<bool> IsLocked = __findLockedVertices(voIndices, NumVertices);
+
+	std::vector<SQuadric> Quadrics(NumVertices);
+	for (size_t i = 0; i < voIndices.size(); i += 3)
+	{
+		glm::dvec3 P0(vVertices[voIndices[i]].Position.x, vVertices[voIndices[i]].Position.y, vVertices[voIndices[i]].Position.z);
+		glm::dvec3 P1(vVertices[voIndices[i + 1]].Position.x, vVertices[voIndices[i + 1]].Position.y, vVertices[voIndices[i + 1]].Position.z);
+		glm::dvec3 P2(vVertices[voIndices[i + 2]].Position.x, vVertices[voIndices[i + 2]].Position.y, vVertices[voIndices[i + 2]].Position.z);
+
+		glm::dvec3 Normal = glm::cross(P1 - P0, P2 - P0);
+		double Area = glm::length(Normal);
+		if (Area <= 0.0) continue;
+		Normal /= Area;
+
+		double Distance = -glm::dot(Normal, P0);
+		for (int k = 0; k < 3; ++k) Quadrics[voIndices[i + k]].addPlane(Normal, Distance, 1.0);
+	}
+
+	std::vector<unsigned> AdjacencyOffsets(NumVertices + 1);
+	std::vector<unsigned> AdjacentTriangles;
+	std::vector<bool> IsTouched(NumVertices);
+	std::vector<SCollapse> Collapses;
+
+	while (voIndices.size() > vTargetNumIndices)
+	{
+		std::fill(AdjacencyOffsets.begin(), AdjacencyOffsets.end(), 0);
+		for (auto Index : voIndices) AdjacencyOffsets[Index + 1]++;
+		for (unsigned i = 0; i < NumVertices; ++i) AdjacencyOffsets[i + 1] += AdjacencyOffsets[i];
+		AdjacentTriangles.resize(voIndices.size());
+		std::vector<unsigned> FillOffsets(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+		for (unsigned i = 0; i < voIndices.size(); ++i) AdjacentTriangles[FillOffsets[voIndices[i]]++] = i / 3;
+
+		Collapses.clear();
+		for (size_t i = 0; i < voIndices.size(); i += 3)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				unsigned A = voIndices[i + k], B = voIndices[i + (k + 1) % 3];
+				if (A == B) continue;
+
+				SQuadric Quadric = Quadrics[A];
+				Quadric.add(Quadrics[B]);
+				if (!IsLocked[A]) Collapses.push_back(SCollapse{ A, B, Quadric.evaluate(vVertices[B].Position) });
+				if (!IsLocked[B]) Collapses.push_back(SCollapse{ B, A, Quadric.evaluate(vVertices[A].Position) });
+			}
+		}
+		std::sort(Collapses.begin(), Collapses.end(), [](const SCollapse& vLeft, const SCollapse& vRight) { return vLeft.Error < vRight.Error; });
+
+		std::fill(IsTouched.begin(), IsTouched.end(), false);
+		std::vector<unsigned> Remap(NumVertices);
+		for (unsigned i = 0; i < NumVertices; ++i) Remap[i] = i;
+
+		size_t NumRemovedIndices = 0;
+		const size_t NumIndicesToRemove = voIndices.size() - vTargetNumIndices;
+		for (const auto& Collapse : Collapses)
+		{
+			if (Collapse.Error > MaxError || NumRemovedIndices >= NumIndicesToRemove) break;
+			if (IsTouched[Collapse.Source] || IsTouched[Collapse.Target]) continue;
+
+			std::vector<unsigned> SourceTriangles(AdjacentTriangles.begin() + AdjacencyOffsets[Collapse.Source], AdjacentTriangles.begin() + AdjacencyOffsets[Collapse.Source + 1]);
+			if (!__isCollapseValid(vVertices, voIndices, SourceTriangles, Collapse.Source, Collapse.Target)) continue;
+
+			//NOTE: the neighbors are frozen for the rest of the pass, so the adjacency and flip test stay valid
+			for (auto Triangle : SourceTriangles)
+			{
+				const unsigned* pCorners = &voIndices[3 * Triangle];
+				if (pCorners[0] == Collapse.Target || pCorners[1] == Collapse.Target || pCorners[2] == Collapse.Target) NumRemovedIndices += 3;
+				for (int k = 0; k < 3; ++k) IsTouched[pCorners[k]] = true;
+			}
+
+			Remap[Collapse.Source] = Collapse.Target;
+			Quadrics[Collapse.Target].add(Quadrics[Collapse.Source]);
+		}
+		if (NumRemovedIndices == 0) break;
+
+		std::vector<unsigned int> Indices;
+		Indices.reserve(voIndices.size());
+		for (size_t i = 0; i < voIndices.size(); i += 3)
+		{
+			unsigned A = Remap[voIndices[i]], B = Remap[voIndices[i + 1]], C = Remap[voIndices[i + 2]];
+			if (A == B || B == C || A == C) continue;
+			Indices.insert(Indices.end(), { A, B, C });
+		}
+		voIndices.swap(Indices);
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION: each level is simplified from the previous one. The chain stops early once a level no longer gets noticeably
+//          smaller, e.g. when the remaining triangles are all on borders or seams
+void CMeshSimplifier::generateLODs(SMeshData& vioMesh, unsigned vNumLODs, float vReductionRatio, float vTargetError)
+{
+	vioMesh.LODs.clear();
+
+	const std::vector<unsigned int>* pPreviousIndices = &vioMesh.Indices;
+	for (unsigned i = 0; i < vNumLODs; ++i)
+	{
+		unsigned TargetNumIndices = static_cast<unsigned>(pPreviousIndices->size() * vReductionRatio) / 3 * 3;
+		if (TargetNumIndices < 3) break;
+
+		std::vector<unsigned int> Indices;
+		simplify(vioMesh.Vertices, *pPreviousIndices, TargetNumIndices, vTargetError * (i + 1), Indices);
+		if (Indices.empty() || Indices.size() > pPreviousIndices->size() * 0.9f) break;
+
+		CMeshOptimizer::optimizeVertexCache(Indices, static_cast<unsigned>(vioMesh.Vertices.size()));
+		vioMesh.LODs.push_back(std::move(Indices));
+		pPreviousIndices = &vioMesh.LODs.back();
+	}
+}
\ No newline at end of file
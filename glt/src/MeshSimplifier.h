@@ -0,0 +1,20 @@
+#pragma once
+#include <vector>
+#include "Mesh.h"
+#include "Export.h"
+
+namespace glt
+{
+	//NOTE: half-edge collapse driven by quadric error metrics. Collapses only move a vertex onto one of its neighbors, so
+	//      the vertex buffer is shared by all levels. Vertices on open edges of the index topology are never moved,
+	//      which keeps the mesh borders as well as the UV and normal seams (split vertices) intact
+	class GLT_DECLSPEC CMeshSimplifier
+	{
+	public:
+		static void simplify(const std::vector<SVertex>& vVertices, const std::vector<unsigned int>& vIndices, unsigned vTargetNumIndices, float vTargetError, std::vector<unsigned int>& voIndices);
+		static void generateLODs(SMeshData& vioMesh, unsigned vNumLODs, float vReductionRatio = 0.5f, float vTargetError = 0.02f);
+
+	private:
+		CMeshSimplifier() = delete;
+	};
+}
\ No newline at end of file
@@ -1,416 +1,187 @@
 #include "Model.h"
-#include <fstream>
-#include <sstream>
-#include <iostream>
-#include <map>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/Importer.hpp>
-#include "Texture.h"
+#include <algorithm>
+#include <atomic>
 #include "Common.h"
 #include "FileLocator.h"
-#include "Utility.h"
 
 using namespace glt;
 
-std::unordered_map<std::string, CModel*> CModel::m_ExsitedModelMap;
-
 //***********************************************************************************************
-//FUNCTION:
-CModel::CModel(const std::string& vFilePath)
+//FUNCTION: the file is only imported if no other model holds its asset yet
+CModel::CModel(const std::string& vFilePath, const SModelLoadOptions& vOptions)
 {
-	m_pImporter = std::make_shared<Assimp::Importer>();
-	m_pBoneInfo = std::make_shared<std::vector<SBoneInfo>>();
-	if (!__loadModel(vFilePath))
+	m_AnimationState.StaggerOffset = __getNextStaggerOffset();
+
+	std::string FilePath = CFileLocator::getInstance()->locateFile(vFilePath);
+	_ASSERTE(!FilePath.empty());
+
+	bool IsCreated = false;
+	m_pAsset = CModelAssetRegistry::getInstance()->getOrCreateAsset(FilePath, vOptions, IsCreated);
+	if (!IsCreated) return;
+
+	if (!m_pAsset->_import())
 	{
+		CModelAssetRegistry::getInstance()->removeFailedAsset(m_pAsset);
 		_OUTPUT_WARNING(format("Failed to load model at %s.", vFilePath.c_str()));
 		_ASSERTE(false);
+		return;
 	}
-}
 
-//***********************************************************************************************
-//FUNCTION:
-CModel::~CModel()
-{
+	m_pAsset->_upload();
 }
 
 //***********************************************************************************************
 //FUNCTION:
-SAABB CModel::getAABB() const
+CModel::CModel(const std::shared_ptr<CModelAsset>& vAsset) : m_pAsset(vAsset)
 {
-	SAABB Box;
-	Box.Min = glm::vec3(1e8, 1e8, 1e8);
-	Box.Max = glm::vec3(-1e8, -1e8, -1e8);
-
-	for (auto mesh : m_Meshes)
-	{
-		Box.Min = min(Box.Min, mesh->getAABB().Min);
-		Box.Max = max(Box.Max, mesh->getAABB().Max);
-	}
-
-	Box.Min += getPosition();
-	Box.Max += getPosition();
-
-	return Box;
+	m_AnimationState.StaggerOffset = __getNextStaggerOffset();
 }
 
-//**********************************************************************************************
+//***********************************************************************************************
 //FUNCTION:
-bool CModel::__loadModel(const std::string& vPath)
+CModel::~CModel()
 {
-	std::string FilePath = CFileLocator::getInstance()->locateFile(vPath);
-	_ASSERTE(!FilePath.empty());
-
-	auto iter = m_ExsitedModelMap.find(FilePath);
-	if (iter != m_ExsitedModelMap.end())
-	{
-		if (nullptr == m_ExsitedModelMap[FilePath]) m_ExsitedModelMap.erase(iter);
-		else { *this = *m_ExsitedModelMap[FilePath]; return true; }
-	}
-
-	m_pScene = m_pImporter->ReadFile(FilePath, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_GenBoundingBoxes);
-
-	if (!m_pScene || m_pScene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !m_pScene->mRootNode) { return false; }
-	m_GlobalInverseTransform = aiMatrix4x4ToGlm(&(m_pScene->mRootNode->mTransformation));
-	glm::inverse(m_GlobalInverseTransform);
-
-	m_Directory = FilePath.substr(0, FilePath.find_last_of('/'));
-	__processNode(m_pScene->mRootNode);
-
-	m_ExsitedModelMap.insert(std::make_pair(FilePath, this));
-
-	return true;
 }
 
-//**********************************************************************************************
-//FUNCTION:
-void CModel::__processNode(const aiNode* vNode)
+//***********************************************************************************************
+//FUNCTION: in world space, bounds the bind pose of a skinned model
+SAABB CModel::getAABB() const
 {
-	for (GLuint i = 0; i < vNode->mNumMeshes; ++i)
-	{
-		aiMesh* mesh = m_pScene->mMeshes[vNode->mMeshes[i]];
-		m_Meshes.push_back(__processMesh(mesh));
-	}
-
-	for (GLuint i = 0; i < vNode->mNumChildren; ++i)
-	{
-		__processNode(vNode->mChildren[i]);
-	}
+	return m_pAsset->getAABB().transform(getModelMatrix());
 }
 
-//**********************************************************************************************
-//FUNCTION:
-std::shared_ptr<CMesh> CModel::__processMesh(const aiMesh* vMesh)
+//***********************************************************************************************
+//FUNCTION: an asset still being imported by another thread draws nothing
+void CModel::_draw(const CShaderProgram& vShaderProgram, EVertexInput vVertexInput, unsigned vLOD, bool vUseSkinnedVertices, unsigned vNumInstances,
+	SBindState* vioBindState) const
 {
-	std::vector<SVertex> Vertices(vMesh->mNumVertices);
-	std::vector<unsigned> Indices(3u * vMesh->mNumFaces);
-	std::vector<std::shared_ptr<CTexture2D>> Textures;
-	std::vector<SUniformInfo> Uniforms;
-
-	_ASSERTE(vMesh->HasNormals());
-	for (unsigned i = 0; i < vMesh->mNumVertices; ++i)
-	{
-		aiVector3D* pPosition = &(vMesh->mVertices[i]);
-		aiVector3D* pNormal = &(vMesh->mNormals[i]);
-		aiVector3D* pTexCoords = vMesh->mTextureCoords[0];
-
-		Vertices[i].Position = glm::vec3(pPosition->x, pPosition->y, pPosition->z);
-		Vertices[i].Normal = glm::vec3(pNormal->x, pNormal->y, pNormal->z);
-		Vertices[i].TexCoords = pTexCoords ? glm::vec2(pTexCoords[i].x, pTexCoords[i].y) : glm::vec2(0.0f);
-	}
-
-	if (vMesh->HasBones()) m_HasBones = true; //TODO:һmeshbones
-	for (unsigned i = 0; i < vMesh->mNumBones; ++i)
-	{
-		unsigned BoneIndex = 0;
-		std::string BoneName(vMesh->mBones[i]->mName.data);
-
-		if (m_BoneName2IndexMap.find(BoneName) == m_BoneName2IndexMap.end())
-		{
-			BoneIndex = m_NumBones;
-			m_NumBones++;
-			m_pBoneInfo->push_back(SBoneInfo());
-			(*m_pBoneInfo)[BoneIndex].BoneOffset = aiMatrix4x4ToGlm(&(vMesh->mBones[i]->mOffsetMatrix));
-			m_BoneName2IndexMap[BoneName] = BoneIndex;
-		}
-		else
-		{
-			BoneIndex = m_BoneName2IndexMap[BoneName];
-		}
-
-		for (unsigned k = 0; k < vMesh->mBones[i]->mNumWeights; k++)
-		{
-			unsigned VertexID = vMesh->mBones[i]->mWeights[k].mVertexId;
-			_ASSERTE(VertexID < Vertices.size());
-
-			for (int m = 0; m < 4; ++m)
-			{
-				if (Vertices[VertexID].BoneWeights[m] == 0.0)
-				{
-					Vertices[VertexID].BoneIDs[m] = BoneIndex;
-					Vertices[VertexID].BoneWeights[m] = vMesh->mBones[i]->mWeights[k].mWeight;
-					break;
-				}
-			}
-		}
-	}
-
-	for (unsigned i = 0; i < vMesh->mNumFaces; ++i)
-	{
-		aiFace Face = vMesh->mFaces[i];
-		_ASSERTE(Face.mNumIndices == 3);
-		Indices.push_back(Face.mIndices[0]);
-		Indices.push_back(Face.mIndices[1]);
-		Indices.push_back(Face.mIndices[2]);
-	}
-
-	if (vMesh->mMaterialIndex >= 0)
-	{
-		aiMaterial* pMaterial = m_pScene->mMaterials[vMesh->mMaterialIndex];
-
-		std::vector<std::shared_ptr<CTexture2D>> DiffuseMaps = __loadMaterialTextures(pMaterial, aiTextureType_DIFFUSE, "uMaterialDiffuseTex");
-		Textures.insert(Textures.end(), DiffuseMaps.begin(), DiffuseMaps.end());
-
-		std::vector<std::shared_ptr<CTexture2D>> SpecularMaps = __loadMaterialTextures(pMaterial, aiTextureType_SPECULAR, "uMaterialSpecularTex");
-		Textures.insert(Textures.end(), SpecularMaps.begin(), SpecularMaps.end());
-
-		aiColor4D DiffuseColor;
-		aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_DIFFUSE, &DiffuseColor);
-		Uniforms.push_back(SUniformInfo{ EUniformType::VEC3F, "uMaterialDiffuse", std::any(glm::vec3(DiffuseColor.r, DiffuseColor.g, DiffuseColor.b)) });
-
-		aiColor4D SpecularColor;
-		aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_DIFFUSE, &SpecularColor);
-		Uniforms.push_back(SUniformInfo{ EUniformType::VEC3F, "uMaterialSpecular", std::any(glm::vec3(SpecularColor.r, SpecularColor.g, SpecularColor.b)) });
-	}
-
-	SAABB AABB;
-	AABB.Max = aiVector3ToGlm(&(vMesh->mAABB.mMax));
-	AABB.Min = aiVector3ToGlm(&(vMesh->mAABB.mMin));
-
-	return std::make_shared<CMesh>(Vertices, Indices, Textures, Uniforms, AABB);
+	if (m_pAsset && m_pAsset->isUploaded())
+		m_pAsset->_draw(vShaderProgram, vVertexInput, vLOD, vUseSkinnedVertices ? &m_AnimationState.SkinnedMeshes : nullptr, vNumInstances, vioBindState);
 }
 
-//**********************************************************************************************
+//***********************************************************************************************
 //FUNCTION:
-std::vector<std::shared_ptr<CTexture2D>> CModel::__loadMaterialTextures(const aiMaterial* vMat, aiTextureType vType, const std::string& vTypeName)
+void CModel::_drawMesh(unsigned vMeshIndex, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput, unsigned vLOD, bool vUseSkinnedVertices,
+	SBindState* vioBindState, const unsigned char* vPartVisibility) const
 {
-	std::vector<std::shared_ptr<CTexture2D>> Textures;
-	for (GLuint i = 0; i < vMat->GetTextureCount(vType); ++i)
-	{
-		aiString Str;
-		vMat->GetTexture(vType, i, &Str);
-
-		GLboolean Skip = false;
-		for (GLuint j = 0; j < m_LoadedTextures.size(); j++)
-		{
-			if (std::strcmp(m_LoadedTextures[j]->getFilePath().c_str(), Str.C_Str()) == 0)
-			{
-				Textures.push_back(m_LoadedTextures[j]);
-				Skip = true;
-				break;
-			}
-		}
-		if (!Skip)
-		{
-			auto TexturePath = this->m_Directory + std::string("/") + std::string(Str.C_Str());
-
-			std::shared_ptr<CTexture2D> pTempTexture = std::make_shared<CTexture2D>();
-			pTempTexture->load(TexturePath.c_str(), GL_REPEAT, GL_LINEAR);
-			pTempTexture->setTextureName(vTypeName);
-			Textures.push_back(pTempTexture);
-			this->m_LoadedTextures.push_back(pTempTexture);
-		}
-	}
-	return Textures;
+	if (m_pAsset && m_pAsset->isUploaded())
+		m_pAsset->_drawMesh(vMeshIndex, vShaderProgram, vVertexInput, vLOD, vUseSkinnedVertices ? &m_AnimationState.SkinnedMeshes : nullptr, 1, vioBindState, vPartVisibility);
 }
 
 //***********************************************************************************************
-//FUNCTION:
-void CModel::_draw(const CShaderProgram& vShaderProgram) const
+//FUNCTION: skins the current pose once, later calls in the same frame return 0 without dispatching anything
+unsigned CModel::_skin(const CShaderProgram& vSkinningProgram) const
 {
-	for (const auto& Mesh : m_Meshes)
-	{
-		Mesh->_draw(vShaderProgram);
-	}
+	_ASSERTE(m_pAsset && m_pAsset->isUploaded() && m_AnimationState.IsPoseUploaded);
+	if (m_AnimationState.IsPoseSkinned) return 0;
+
+	m_AnimationState.IsPoseSkinned = true;
+	return m_pAsset->_skin(vSkinningProgram, m_AnimationState.SkinnedMeshes);
 }
 
 //***********************************************************************************************
-//FUNCTION:
-void CModel::_boneTransform(float vTimeInSeconds, std::vector<glm::mat4>& voTransforms) const
+//FUNCTION: the cursors of the old clip do not apply to the new one
+void CModel::setAnimationClip(unsigned vClipIndex)
 {
-	glm::mat4 Identity = glm::identity<glm::mat4>();
-	_ASSERTE(m_pScene->HasAnimations());
-
-	float TicksPerSecond = m_pScene->mAnimations[0]->mTicksPerSecond != 0 ? m_pScene->mAnimations[0]->mTicksPerSecond : 25.0f;
-	float TimeInTicks = vTimeInSeconds * TicksPerSecond;
-	float AnimationTime = std::fmod(TimeInTicks, m_pScene->mAnimations[0]->mDuration);
+	if (vClipIndex == m_AnimationState.ClipIndex) return;
 
-	__readNodeHeirarchy(AnimationTime, m_pScene->mRootNode, Identity);
-
-	voTransforms.resize(m_NumBones);
-	for (unsigned i = 0; i < m_NumBones; i++) voTransforms[i] = (*m_pBoneInfo)[i].FinalTransformation;
+	m_AnimationState.ClipIndex = vClipIndex;
+	m_AnimationState.Workspace.Cursors.clear();
+	m_AnimationState.PoseFrameIndex = UINT_MAX;
+	m_AnimationState.TargetPose.clear();
 }
 
 //***********************************************************************************************
-//FUNCTION:
-void CModel::__readNodeHeirarchy(float vAnimationTime, const aiNode* vNode, const glm::mat4& vParentTransform) const
+//FUNCTION: touches nothing but the state of this instance, different instances may be updated concurrently. A skinned
+//          model without clips stays in its bind pose. Returns whether the clip was evaluated, which on a frame that is
+//          only blended between cached poses it is not. vFrameTime is the expected time until the next frame
+bool CModel::_updatePose(float vTimeInSeconds, unsigned vFrameIndex, float vFrameTime) const
 {
-	std::string NodeName(vNode->mName.data);
-
-	const aiAnimation* pAnimation = m_pScene->mAnimations[0];
-
-	glm::mat4 NodeTransformation = aiMatrix4x4ToGlm(&(vNode->mTransformation));
-
-	const aiNodeAnim* pNodeAnim = __findNodeAnim(pAnimation, NodeName);
+	_ASSERTE(m_pAsset);
+	SAnimationState& State = m_AnimationState;
+	State.PoseFrameIndex = vFrameIndex;
+	State.PoseTime = vTimeInSeconds;
+	State.IsPoseUploaded = false;
+	State.IsPoseSkinned = false;
 
-	if (pNodeAnim)
+	if (m_pAsset->getNumAnimationClips() == 0)
 	{
-		// Interpolate scaling and generate scaling transformation matrix
-		aiVector3D Scaling;
-		__calcInterpolatedScaling(Scaling, vAnimationTime, pNodeAnim);
-		glm::mat4 ScalingM = glm::scale(glm::mat4(1.0), glm::vec3(Scaling.x, Scaling.y, Scaling.z));
-
-		// Interpolate rotation and generate rotation transformation matrix
-		aiQuaternion RotationQ;
-		__calcInterpolatedRotation(RotationQ, vAnimationTime, pNodeAnim);
-		glm::mat4 RotationM = aiMatrix4x4ToGlm(&aiMatrix4x4(RotationQ.GetMatrix()));
-
-		// Interpolate translation and generate translation transformation matrix
-		aiVector3D Translation;
-		__calcInterpolatedPosition(Translation, vAnimationTime, pNodeAnim);
-		glm::mat4 TranslationM = glm::translate(glm::mat4(1.0), glm::vec3(Translation.x, Translation.y, Translation.z));
-
-		// Combine the above transformations
-		NodeTransformation = TranslationM * RotationM * ScalingM;
+		State.BoneTransforms.assign(std::max(m_pAsset->m_NumBones, 1u), glm::mat4(1.0f));
+		return false;
 	}
 
-	glm::mat4 GlobalTransformation = vParentTransform * NodeTransformation;
-
-	if (m_BoneName2IndexMap.find(NodeName) != m_BoneName2IndexMap.end())
+	if (State.UpdateInterval <= 1 || vFrameTime <= 0.0f)
 	{
-		unsigned BoneIndex = m_BoneName2IndexMap.at(NodeName);
-		(*m_pBoneInfo)[BoneIndex].FinalTransformation = m_GlobalInverseTransform * GlobalTransformation * (*m_pBoneInfo)[BoneIndex].BoneOffset;
+		State.TargetPose.clear();
+		__evaluatePose(vTimeInSeconds, State.BoneTransforms);
+		return true;
 	}
 
-	for (unsigned i = 0; i < vNode->mNumChildren; ++i)
-		__readNodeHeirarchy(vAnimationTime, vNode->mChildren[i], GlobalTransformation);
-}
+	EPoseUpdate Update = schedulePose(vTimeInSeconds, vFrameIndex, vFrameTime, State.UpdateInterval, State.StaggerOffset, !State.TargetPose.empty(),
+		State.SourceTime, State.TargetTime);
+	if (Update == EPoseUpdate::ADVANCE) State.SourcePose.swap(State.TargetPose);
+	else if (Update == EPoseUpdate::RESTART) __evaluatePose(State.SourceTime, State.SourcePose);
+	if (Update != EPoseUpdate::BLEND) __evaluatePose(State.TargetTime, State.TargetPose);
 
-//***********************************************************************************************
-//FUNCTION:
-const aiNodeAnim* CModel::__findNodeAnim(const aiAnimation* vAnimation, const std::string vNodeName) const
-{
-	for (unsigned i = 0; i < vAnimation->mNumChannels; i++)
-	{
-		const aiNodeAnim* pNodeAnim = vAnimation->mChannels[i];
-		if (std::string(pNodeAnim->mNodeName.data) == vNodeName) return pNodeAnim;
-	}
-	return nullptr;
-}
+	float Factor = computePoseBlendFactor(vTimeInSeconds, State.SourceTime, State.TargetTime);
 
-//***********************************************************************************************
-//FUNCTION:
-void CModel::__calcInterpolatedPosition(aiVector3D& voVector, float vAnimationTime, const aiNodeAnim* vNodeAnim) const
-{
-	if (vNodeAnim->mNumPositionKeys == 1)
-	{
-		voVector = vNodeAnim->mPositionKeys[0].mValue;
-		return;
-	}
+	State.BoneTransforms.resize(State.TargetPose.size());
+	for (size_t i = 0; i < State.TargetPose.size(); ++i)
+		State.BoneTransforms[i] = State.SourcePose[i] * (1.0f - Factor) + State.TargetPose[i] * Factor;
 
-	unsigned PositionIndex = __findPosition(vAnimationTime, vNodeAnim);
-	unsigned NextPositionIndex = (PositionIndex + 1);
-	_ASSERTE(NextPositionIndex < vNodeAnim->mNumPositionKeys);
-	float DeltaTime = (float)(vNodeAnim->mPositionKeys[NextPositionIndex].mTime - vNodeAnim->mPositionKeys[PositionIndex].mTime);
-	float Factor = (vAnimationTime - (float)vNodeAnim->mPositionKeys[PositionIndex].mTime) / DeltaTime;
-	_ASSERTE(Factor >= 0.0f && Factor <= 1.0f);
-	const aiVector3D& Start = vNodeAnim->mPositionKeys[PositionIndex].mValue;
-	const aiVector3D& End = vNodeAnim->mPositionKeys[NextPositionIndex].mValue;
-	aiVector3D Delta = End - Start;
-	voVector = Start + Factor * Delta;
+	return Update != EPoseUpdate::BLEND;
 }
 
 //***********************************************************************************************
-//FUNCTION:
-void CModel::__calcInterpolatedScaling(aiVector3D& voVector, float vAnimationTime, const aiNodeAnim* vNodeAnim) const
+//FUNCTION: moves the times of the cached poses on and tells which poses to evaluate. The target is evaluated on the frames
+//          where (frame + stagger offset) % interval is 0, each time one interval ahead of the source. A frame without
+//          valid cached poses restarts from the current time with a target due on the next frame of the instance, so
+//          that the blended pose follows the time from the first frame on. A frame running late holds the target pose
+//          until the next evaluation is due rather than evaluating out of turn
+EPoseUpdate CModel::schedulePose(float vTimeInSeconds, unsigned vFrameIndex, float vFrameTime, unsigned vUpdateInterval, unsigned vStaggerOffset,
+	bool vHasTargetPose, float& vioSourceTime, float& vioTargetTime)
 {
-	if (vNodeAnim->mNumScalingKeys == 1)
-	{
-		voVector = vNodeAnim->mScalingKeys[0].mValue;
-		return;
-	}
+	_ASSERTE(vUpdateInterval > 0);
+	float MaxDelay = vUpdateInterval * vFrameTime;
+	bool IsCacheValid = vHasTargetPose && vTimeInSeconds >= vioSourceTime && vTimeInSeconds <= vioTargetTime + MaxDelay;
+	unsigned Phase = (vFrameIndex + vStaggerOffset) % vUpdateInterval;
 
-	unsigned ScalingIndex = __findScaling(vAnimationTime, vNodeAnim);
-	unsigned NextScalingIndex = (ScalingIndex + 1);
-	_ASSERTE(NextScalingIndex < vNodeAnim->mNumScalingKeys);
-	float DeltaTime = (float)(vNodeAnim->mScalingKeys[NextScalingIndex].mTime - vNodeAnim->mScalingKeys[ScalingIndex].mTime);
-	float Factor = (vAnimationTime - (float)vNodeAnim->mScalingKeys[ScalingIndex].mTime) / DeltaTime;
-	_ASSERTE(Factor >= 0.0f && Factor <= 1.0f);
-	const aiVector3D& Start = vNodeAnim->mScalingKeys[ScalingIndex].mValue;
-	const aiVector3D& End = vNodeAnim->mScalingKeys[NextScalingIndex].mValue;
-	aiVector3D Delta = End - Start;
-	voVector = Start + Factor * Delta;
-}
-
-//***********************************************************************************************
-//FUNCTION:
-void CModel::__calcInterpolatedRotation(aiQuaternion& voQuaternion, float vAnimationTime, const aiNodeAnim* vNodeAnim) const
-{
-	// we need at least two values to interpolate...
-	if (vNodeAnim->mNumRotationKeys == 1)
+	if (IsCacheValid)
 	{
-		voQuaternion = vNodeAnim->mRotationKeys[0].mValue;
-		return;
+		if (Phase != 0) return EPoseUpdate::BLEND;
+
+		vioSourceTime = vioTargetTime;
+		vioTargetTime = std::max(vioSourceTime, vTimeInSeconds) + MaxDelay;
+		return EPoseUpdate::ADVANCE;
 	}
 
-	unsigned RotationIndex = __findRotation(vAnimationTime, vNodeAnim);
-	unsigned NextRotationIndex = (RotationIndex + 1);
-	_ASSERTE(NextRotationIndex < vNodeAnim->mNumRotationKeys);
-	float DeltaTime = vNodeAnim->mRotationKeys[NextRotationIndex].mTime - vNodeAnim->mRotationKeys[RotationIndex].mTime;
-	float Factor = (vAnimationTime - (float)vNodeAnim->mRotationKeys[RotationIndex].mTime) / DeltaTime;
-	_ASSERTE(Factor >= 0.0f && Factor <= 1.0f);
-	const aiQuaternion& StartRotationQ = vNodeAnim->mRotationKeys[RotationIndex].mValue;
-	const aiQuaternion& EndRotationQ = vNodeAnim->mRotationKeys[NextRotationIndex].mValue;
-	aiQuaternion::Interpolate(voQuaternion, StartRotationQ, EndRotationQ, Factor);
-	voQuaternion = voQuaternion.Normalize();
+	unsigned NumFramesToNextUpdate = (Phase == 0) ? vUpdateInterval : vUpdateInterval - Phase;
+	vioSourceTime = vTimeInSeconds;
+	vioTargetTime = vTimeInSeconds + NumFramesToNextUpdate * vFrameTime;
+	return EPoseUpdate::RESTART;
 }
 
 //***********************************************************************************************
 //FUNCTION:
-unsigned CModel::__findRotation(float vAnimationTime, const aiNodeAnim* vNodeAnim) const
+float CModel::computePoseBlendFactor(float vTimeInSeconds, float vSourceTime, float vTargetTime)
 {
-	_ASSERTE(vNodeAnim->mNumRotationKeys > 0);
-
-	for (unsigned i = 0; i < vNodeAnim->mNumRotationKeys - 1; ++i)
-		if (vAnimationTime < (float)vNodeAnim->mRotationKeys[i + 1].mTime) return i;
-
-	_ASSERTE(false);
-	return 0;
+	float Interval = vTargetTime - vSourceTime;
+	return (Interval > 0.0f) ? glm::clamp((vTimeInSeconds - vSourceTime) / Interval, 0.0f, 1.0f) : 1.0f;
 }
 
 //***********************************************************************************************
 //FUNCTION:
-unsigned CModel::__findPosition(float vAnimationTime, const aiNodeAnim* vNodeAnim) const
+void CModel::__evaluatePose(float vTimeInSeconds, std::vector<glm::mat4>& voBoneTransforms) const
 {
-	_ASSERTE(vNodeAnim->mNumPositionKeys > 0);
-
-	for (unsigned i = 0; i < vNodeAnim->mNumPositionKeys - 1; i++)
-		if (vAnimationTime < (float)vNodeAnim->mPositionKeys[i + 1].mTime) return i;
-
-	_ASSERTE(false);
-	return 0;
+	unsigned ClipIndex = std::min(m_AnimationState.ClipIndex, m_pAsset->getNumAnimationClips() - 1);
+	float Time = vTimeInSeconds * m_AnimationState.Speed + m_AnimationState.TimeOffset;
+	m_pAsset->_boneTransform(ClipIndex, Time, voBoneTransforms, m_AnimationState.Workspace);
 }
 
 //***********************************************************************************************
-//FUNCTION:
-unsigned CModel::__findScaling(float vAnimationTime, const aiNodeAnim* vNodeAnim) const
+//FUNCTION: hands out the offsets round robin, which spreads instances evenly over the frames of every interval
+unsigned CModel::__getNextStaggerOffset()
 {
-	_ASSERTE(vNodeAnim->mNumScalingKeys > 0);
-
-	for (unsigned i = 0; i < vNodeAnim->mNumScalingKeys - 1; i++)
-		if (vAnimationTime < (float)vNodeAnim->mScalingKeys[i + 1].mTime) return i;
-
-	_ASSERTE(false);
-	return 0;
+	static std::atomic<unsigned> NextStaggerOffset(0);
+	return NextStaggerOffset++;
 }
\ No newline at end of file
@@ -1,67 +1,137 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <unordered_map>
 #include <memory>
-#include <assimp/scene.h>
+#include <climits>
 #include "Entity.h"
-#include "Mesh.h"
+#include "ModelAsset.h"
 #include "Export.h"
 
 namespace glt
 {
-	struct SBoneInfo
+	class CShaderProgram;
+
+	//NOTE: the animation of one instance. The instance plays its clip at Speed times the renderer time shifted by TimeOffset.
+	//      A copy only takes the settings, the poses and the skinned vertices of the copy are its own and rebuilt lazily
+	struct SAnimationState
 	{
-		glm::mat4 BoneOffset;
-		glm::mat4 FinalTransformation;
+		SAnimationState() = default;
+		SAnimationState(const SAnimationState& vOther) { *this = vOther; }
+
+		SAnimationState& operator=(const SAnimationState& vOther)
+		{
+			if (this == &vOther) return *this;
+
+			ClipIndex = vOther.ClipIndex;
+			Speed = vOther.Speed;
+			TimeOffset = vOther.TimeOffset;
+			UpdateInterval = vOther.UpdateInterval;
+			StaggerOffset = vOther.StaggerOffset;
+
+			Workspace = SPoseWorkspace();
+			BoneTransforms.clear();
+			PoseFrameIndex = UINT_MAX;
+			PoseTime = 0.0f;
+			SourcePose.clear();
+			TargetPose.clear();
+			SourceTime = TargetTime = 0.0f;
+			PaletteOffset = 0;
+			IsPoseUploaded = false;
+			SkinnedMeshes.clear();
+			IsPoseSkinned = false;
+			return *this;
+		}
+
+		unsigned ClipIndex = 0;
+		float Speed = 1.0f;
+		float TimeOffset = 0.0f;
+
+		SPoseWorkspace Workspace;
+		std::vector<glm::mat4> BoneTransforms;
+		unsigned PoseFrameIndex = UINT_MAX;
+		float PoseTime = 0.0f;
+
+		//NOTE: with an UpdateInterval above 1 the pose is only evaluated every UpdateInterval frames, one interval ahead of
+		//      time into TargetPose. The frames in between blend from SourcePose towards it. StaggerOffset shifts the
+		//      frames an instance evaluates in, so that instances on the same interval spread over all its frames
+		unsigned UpdateInterval = 1;
+		unsigned StaggerOffset = 0;
+		std::vector<glm::mat4> SourcePose;
+		std::vector<glm::mat4> TargetPose;
+		float SourceTime = 0.0f;
+		float TargetTime = 0.0f;
+
+		unsigned PaletteOffset = 0;
+		bool IsPoseUploaded = false;
+
+		//NOTE: filled by the pre-skinning pass, one entry per mesh of the asset
+		std::vector<SSkinnedVertices> SkinnedMeshes;
+		bool IsPoseSkinned = false;
 	};
 
-	class CShaderProgram;
-	class CTexture2D;
+	//NOTE: what a frame of a pose updated every few frames does with the cached poses. ADVANCE makes the target the source
+	//      and evaluates a new target, RESTART evaluates both anew
+	enum class EPoseUpdate : unsigned char
+	{
+		BLEND = 0,
+		ADVANCE,
+		RESTART,
+	};
 
+	//NOTE: an instance of a model asset. A copy shares the asset and takes the transform and the animation settings, its
+	//      poses and skinned vertices are built anew
 	class GLT_DECLSPEC CModel : public CEntity
 	{
 	public:
-		CModel(const std::string& vFilePath);
+		CModel(const std::string& vFilePath, const SModelLoadOptions& vOptions = SModelLoadOptions());
 		~CModel();
 
+		const std::shared_ptr<CModelAsset>& getAsset() const { return m_pAsset; }
+
 		SAABB getAABB() const;
+		size_t getVertexMemorySize() const { return m_pAsset ? m_pAsset->getVertexMemorySize() : 0; }
+		size_t getIndexMemorySize() const { return m_pAsset ? m_pAsset->getIndexMemorySize() : 0; }
+		unsigned getNumDrawCalls() const { return m_pAsset ? m_pAsset->getNumDrawCalls() : 0; }
+		unsigned getNumLODs() const { return (m_pAsset && m_pAsset->isUploaded()) ? m_pAsset->getNumLODs() : 1; }
+		unsigned getCurrentLOD() const { return m_CurrentLOD; }
+
+		unsigned getNumAnimationClips() const { return (m_pAsset && m_pAsset->isUploaded()) ? m_pAsset->getNumAnimationClips() : 0; }
+		unsigned getAnimationClip() const { return m_AnimationState.ClipIndex; }
+		void setAnimationClip(unsigned vClipIndex);
+		void setAnimationSpeed(float vSpeed) { m_AnimationState.Speed = vSpeed; }
+		void setAnimationTimeOffset(float vTimeOffset) { m_AnimationState.TimeOffset = vTimeOffset; }
+
+		static EPoseUpdate schedulePose(float vTimeInSeconds, unsigned vFrameIndex, float vFrameTime, unsigned vUpdateInterval, unsigned vStaggerOffset,
+			bool vHasTargetPose, float& vioSourceTime, float& vioTargetTime);
+		static float computePoseBlendFactor(float vTimeInSeconds, float vSourceTime, float vTargetTime);
 
 	protected:
-		void _draw(const CShaderProgram& vShaderProgram) const;
-		bool _hasBones() const { return m_HasBones; }
-		void _boneTransform(float vTimeInSeconds, std::vector<glm::mat4>& voTransforms) const;
+		CModel(const std::shared_ptr<CModelAsset>& vAsset);
+
+		void _draw(const CShaderProgram& vShaderProgram, EVertexInput vVertexInput = EVertexInput::Full, unsigned vLOD = 0, bool vUseSkinnedVertices = false,
+			unsigned vNumInstances = 1, SBindState* vioBindState = nullptr) const;
+		void _drawMesh(unsigned vMeshIndex, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput = EVertexInput::Full, unsigned vLOD = 0,
+			bool vUseSkinnedVertices = false, SBindState* vioBindState = nullptr, const unsigned char* vPartVisibility = nullptr) const;
+		unsigned _skin(const CShaderProgram& vSkinningProgram) const;
+		bool _hasBones() const { return m_pAsset && m_pAsset->hasBones(); }
+		bool _isPoseUpToDate(unsigned vFrameIndex, float vTimeInSeconds) const { return m_AnimationState.PoseFrameIndex == vFrameIndex && m_AnimationState.PoseTime == vTimeInSeconds; }
+		bool _updatePose(float vTimeInSeconds, unsigned vFrameIndex, float vFrameTime = 0.0f) const;
+		const std::vector<glm::mat4>& _getBoneTransforms() const { return m_AnimationState.BoneTransforms; }
 
 	private:
-		void __processNode(const aiNode* vNode);
-		std::shared_ptr<CMesh> __processMesh(const aiMesh* vMesh);
-		std::vector<std::shared_ptr<CTexture2D>> __loadMaterialTextures(const aiMaterial* vMat, aiTextureType vType, const std::string& vTypeName);
-		bool __loadModel(const std::string& vPath);
-
-		void __readNodeHeirarchy(float vAnimationTime, const aiNode* vNode, const glm::mat4& vParentTransform) const;
-		const aiNodeAnim* __findNodeAnim(const aiAnimation* vAnimation, const std::string vNodeName) const;
-		void __calcInterpolatedPosition(aiVector3D& voVector, float vAnimationTime, const aiNodeAnim* vNodeAnim) const;
-		void __calcInterpolatedRotation(aiQuaternion& voQuaternion, float vAnimationTime, const aiNodeAnim* vNodeAnim) const;
-		void __calcInterpolatedScaling(aiVector3D& voVector, float vAnimationTime, const aiNodeAnim* vNodeAnim) const;
-		unsigned __findPosition(float vAnimationTime, const aiNodeAnim* vNodeAnim) const;
-		unsigned __findRotation(float vAnimationTime, const aiNodeAnim* vNodeAnim) const;
-		unsigned __findScaling(float vAnimationTime, const aiNodeAnim* vNodeAnim) const;
-
-		std::vector<std::shared_ptr<CMesh>>			m_Meshes;
-		std::vector<std::shared_ptr<CTexture2D>>	m_LoadedTextures;
-
-		std::shared_ptr<Assimp::Importer> m_pImporter;
-		const aiScene* m_pScene = nullptr;
-		std::string m_Directory;
-
-		std::unordered_map<std::string, unsigned>		m_BoneName2IndexMap;
-		mutable std::shared_ptr<std::vector<SBoneInfo>>	m_pBoneInfo;
-		unsigned	m_NumBones = 0;
-		bool		m_HasBones = false;
-		glm::mat4	m_GlobalInverseTransform;
-
-		static std::unordered_map<std::string, CModel*> m_ExsitedModelMap;
+		void __evaluatePose(float vTimeInSeconds, std::vector<glm::mat4>& voBoneTransforms) const;
+
+		static unsigned __getNextStaggerOffset();
+
+		std::shared_ptr<CModelAsset> m_pAsset;
+
+		//NOTE: the LOD is picked by the renderer once per frame so that every pass of a frame draws the same triangles
+		mutable unsigned m_CurrentLOD = 0;
+		mutable unsigned m_LODFrameIndex = UINT_MAX;
+
+		mutable SAnimationState m_AnimationState;
 
 		friend class CRenderer;
+		friend class CScene;
 	};
 }
\ No newline at end of file
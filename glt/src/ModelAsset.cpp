@@ -0,0 +1,588 @@
+#include "ModelAsset.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/Importer.hpp>
+#include <assimp/DefaultIOSystem.h>
+#include "Texture.h"
+#include "TextureCache.h"
+#include "Common.h"
+#include "FileLocator.h"
+#include "Utility.h"
+#include "CpuTimer.h"
+#include "ModelCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "AnimationCompressor.h"
+
+using namespace glt;
+
+constexpr unsigned IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_GenBoundingBoxes;
+constexpr unsigned OPTIMIZE_MESH_FLAG = 0x1;
+constexpr unsigned OPTIMIZE_OVERDRAW_FLAG = 0x2;
+constexpr unsigned GENERATE_LOD_FLAG = 0x4;
+constexpr unsigned NUM_GENERATED_LODS = 3;
+
+namespace
+{
+	//NOTE: records every file Assimp opens while importing a model, such as the material library of an OBJ file, so that
+	//      the model cache can tell when one of them changes
+	class CRecordingIOSystem : public Assimp::DefaultIOSystem
+	{
+	public:
+		CRecordingIOSystem(std::vector<std::string>& voOpenedFiles) : m_OpenedFiles(voOpenedFiles) {}
+
+		using Assimp::DefaultIOSystem::Open;
+		Assimp::IOStream* Open(const char* vFilePath, const char* vMode = "rb") override
+		{
+			Assimp::IOStream* pStream = Assimp::DefaultIOSystem::Open(vFilePath, vMode);
+			if (pStream) m_OpenedFiles.push_back(vFilePath);
+			return pStream;
+		}
+
+	private:
+		std::vector<std::string>& m_OpenedFiles;
+	};
+
+	//NOTE: the scene is owned by the importer, this only makes sure no pointer to it outlives the import
+	struct SSceneGuard
+	{
+		const aiScene*& pScene;
+		~SSceneGuard() { pScene = nullptr; }
+	};
+}
+
+//***********************************************************************************************
+//FUNCTION:
+CModelAsset::CModelAsset(const std::string& vFilePath, const SModelLoadOptions& vOptions) : m_FilePath(vFilePath), m_Options(vOptions)
+{
+}
+
+//***********************************************************************************************
+//FUNCTION:
+CModelAsset::~CModelAsset()
+{
+}
+
+//***********************************************************************************************
+//FUNCTION: in the local space of the model
+SAABB CModelAsset::getAABB() const
+{
+	SAABB Box;
+	Box.Min = glm::vec3(1e8, 1e8, 1e8);
+	Box.Max = glm::vec3(-1e8, -1e8, -1e8);
+
+	for (auto mesh : m_Meshes)
+	{
+		Box.Min = min(Box.Min, mesh->getAABB().Min);
+		Box.Max = max(Box.Max, mesh->getAABB().Max);
+	}
+
+	return Box;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+size_t CModelAsset::getVertexMemorySize() const
+{
+	size_t Size = 0;
+	for (const auto& pMesh : m_Meshes) Size += pMesh->getVertexMemorySize();
+	return Size;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+size_t CModelAsset::getIndexMemorySize() const
+{
+	size_t Size = 0;
+	for (const auto& pMesh : m_Meshes) Size += pMesh->getIndexMemorySize();
+	return Size;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+unsigned CModelAsset::getNumDrawCalls() const
+{
+	unsigned NumDrawCalls = 0;
+	for (const auto& pMesh : m_Meshes) NumDrawCalls += pMesh->getNumDrawCalls();
+	return NumDrawCalls;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+unsigned CModelAsset::getNumLODs() const
+{
+	unsigned NumLODs = 1;
+	for (const auto& pMesh : m_Meshes) NumLODs = std::max(NumLODs, pMesh->getNumLODs());
+	return NumLODs;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+unsigned CModelAsset::getNumTriangles(unsigned vLOD) const
+{
+	unsigned NumTriangles = 0;
+	for (const auto& pMesh : m_Meshes) NumTriangles += pMesh->getNumTriangles(vLOD);
+	return NumTriangles;
+}
+
+//**********************************************************************************************
+//FUNCTION: only touches the CPU side (Assimp or the mesh cache), so it can run on a worker thread
+bool CModelAsset::_import()
+{
+	_EARLY_RETURN(m_FilePath.empty(), "The model asset has no file path.", false);
+	m_Directory = m_FilePath.substr(0, m_FilePath.find_last_of('/'));
+
+	CCPUTimer Timer;
+	Timer.start();
+
+	auto pCache = std::make_shared<CModelCache>();
+	if (pCache->load(m_FilePath, IMPORT_FLAGS, __getOptimizationFlags()))
+	{
+		m_pPendingCache = pCache;
+
+		Timer.stop();
+		_OUTPUT_EVENT(format("Loaded model %s from cache in %.2f ms (cold import: %.2f ms)", m_FilePath.c_str(), Timer.getElapsedTimeInMS(), pCache->getImportTime()));
+		return true;
+	}
+
+	//NOTE: the importer frees the scene when it goes out of scope, whichever way the import ends
+	std::vector<std::string> Dependencies;
+	Assimp::Importer Importer;
+	Importer.SetIOHandler(new CRecordingIOSystem(Dependencies));
+	m_pScene = Importer.ReadFile(m_FilePath, IMPORT_FLAGS);
+	SSceneGuard SceneGuard{ m_pScene };
+
+	if (!m_pScene || m_pScene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !m_pScene->mRootNode) { return false; }
+	m_GlobalInverseTransform = aiMatrix4x4ToGlm(&(m_pScene->mRootNode->mTransformation));
+	glm::inverse(m_GlobalInverseTransform);
+
+	__processNode(m_pScene->mRootNode, m_PendingMeshes);
+	if (m_pScene->HasAnimations()) __loadAnimations();
+	if (m_Options.OptimizeMeshes) __optimizeMeshes(m_PendingMeshes);
+	if (m_Options.GenerateLODs) __generateLODs(m_PendingMeshes);
+
+	Timer.stop();
+	double ImportTime = Timer.getElapsedTimeInMS();
+	_OUTPUT_EVENT(format("Imported model %s in %.2f ms", m_FilePath.c_str(), ImportTime));
+
+	//NOTE: the skeleton and the clips are not part of the cache yet, so only static models are cached for now
+	if (!m_HasBones && !m_pScene->HasAnimations()) CModelCache::save(m_FilePath, IMPORT_FLAGS, __getOptimizationFlags(), m_PendingMeshes, Dependencies, ImportTime);
+
+	return true;
+}
+
+//**********************************************************************************************
+//FUNCTION: must be called on the thread owning the GL context. With MergeMeshBuffers all meshes of the model share one
+//          vertex and one index allocation and meshes with the same material are drawn with one multi-draw call
+void CModelAsset::_upload()
+{
+	std::vector<SMeshPart> Parts;
+	if (m_pPendingCache)
+	{
+		for (const auto& Mesh : m_pPendingCache->getMeshes())
+			Parts.push_back(__createMeshPart(Mesh.pVertices, Mesh.NumVertices, Mesh.pIndices, Mesh.NumIndices, Mesh.Textures, Mesh.Uniforms, Mesh.AABB, Mesh.LODs));
+	}
+
+	for (const auto& Mesh : m_PendingMeshes)
+	{
+		std::vector<SMeshLOD> LODs;
+		for (const auto& LOD : Mesh.LODs) LODs.push_back(SMeshLOD{ LOD.data(), static_cast<unsigned>(LOD.size()) });
+		Parts.push_back(__createMeshPart(Mesh.Vertices.data(), Mesh.Vertices.size(), Mesh.Indices.data(), Mesh.Indices.size(), Mesh.Textures, Mesh.Uniforms, Mesh.AABB, LODs));
+	}
+
+	if (m_Options.MergeMeshBuffers && !Parts.empty()) m_Meshes.push_back(std::make_shared<CMesh>(Parts, m_Options.PackVertices));
+	else
+	{
+		for (const auto& Part : Parts) m_Meshes.push_back(std::make_shared<CMesh>(std::vector<SMeshPart>{ Part }, m_Options.PackVertices));
+	}
+
+	m_pPendingCache.reset();
+	m_PendingMeshes.clear();
+	m_PendingMeshes.shrink_to_fit();
+
+	_OUTPUT_EVENT(format("Uploaded model %s: %.2f MB vertex data (%s), %.2f MB index data, %u meshes in %u draw calls", m_FilePath.c_str(), getVertexMemorySize() / (1024.0 * 1024.0),
+		m_Options.PackVertices ? "packed" : "unpacked", getIndexMemorySize() / (1024.0 * 1024.0), static_cast<unsigned>(Parts.size()), getNumDrawCalls()));
+
+	m_IsUploaded = true;
+}
+
+//**********************************************************************************************
+//FUNCTION:
+void CModelAsset::__processNode(const aiNode* vNode, std::vector<SMeshData>& voMeshes)
+{
+	for (GLuint i = 0; i < vNode->mNumMeshes; ++i)
+	{
+		aiMesh* mesh = m_pScene->mMeshes[vNode->mMeshes[i]];
+		voMeshes.push_back(__processMesh(mesh));
+	}
+
+	for (GLuint i = 0; i < vNode->mNumChildren; ++i)
+	{
+		__processNode(vNode->mChildren[i], voMeshes);
+	}
+}
+
+//**********************************************************************************************
+//FUNCTION:
+SMeshData CModelAsset::__processMesh(const aiMesh* vMesh)
+{
+	SMeshData MeshData;
+	std::vector<SVertex>& Vertices = MeshData.Vertices;
+	std::vector<unsigned>& Indices = MeshData.Indices;
+	std::vector<STextureInfo>& Textures = MeshData.Textures;
+	std::vector<SUniformInfo>& Uniforms = MeshData.Uniforms;
+
+	Vertices.resize(vMesh->mNumVertices);
+	Indices.reserve(3u * vMesh->mNumFaces);
+
+	_ASSERTE(vMesh->HasNormals());
+	for (unsigned i = 0; i < vMesh->mNumVertices; ++i)
+	{
+		aiVector3D* pPosition = &(vMesh->mVertices[i]);
+		aiVector3D* pNormal = &(vMesh->mNormals[i]);
+		aiVector3D* pTexCoords = vMesh->mTextureCoords[0];
+
+		Vertices[i].Position = glm::vec3(pPosition->x, pPosition->y, pPosition->z);
+		Vertices[i].Normal = glm::vec3(pNormal->x, pNormal->y, pNormal->z);
+		Vertices[i].TexCoords = pTexCoords ? glm::vec2(pTexCoords[i].x, pTexCoords[i].y) : glm::vec2(0.0f);
+	}
+
+	if (vMesh->HasBones()) m_HasBones = true; //TODO: not every mesh necessarily has bones
+	for (unsigned i = 0; i < vMesh->mNumBones; ++i)
+	{
+		unsigned BoneIndex = 0;
+		std::string BoneName(vMesh->mBones[i]->mName.data);
+
+		if (m_BoneName2IndexMap.find(BoneName) == m_BoneName2IndexMap.end())
+		{
+			BoneIndex = m_NumBones;
+			m_NumBones++;
+			m_BoneOffsets.push_back(aiMatrix4x4ToGlm(&(vMesh->mBones[i]->mOffsetMatrix)));
+			m_BoneName2IndexMap[BoneName] = BoneIndex;
+		}
+		else
+		{
+			BoneIndex = m_BoneName2IndexMap[BoneName];
+		}
+
+		for (unsigned k = 0; k < vMesh->mBones[i]->mNumWeights; k++)
+		{
+			unsigned VertexID = vMesh->mBones[i]->mWeights[k].mVertexId;
+			_ASSERTE(VertexID < Vertices.size());
+
+			for (int m = 0; m < 4; ++m)
+			{
+				if (Vertices[VertexID].BoneWeights[m] == 0.0)
+				{
+					Vertices[VertexID].BoneIDs[m] = BoneIndex;
+					Vertices[VertexID].BoneWeights[m] = vMesh->mBones[i]->mWeights[k].mWeight;
+					break;
+				}
+			}
+		}
+	}
+
+	for (unsigned i = 0; i < vMesh->mNumFaces; ++i)
+	{
+		aiFace Face = vMesh->mFaces[i];
+		_ASSERTE(Face.mNumIndices == 3);
+		Indices.push_back(Face.mIndices[0]);
+		Indices.push_back(Face.mIndices[1]);
+		Indices.push_back(Face.mIndices[2]);
+	}
+
+	if (vMesh->mMaterialIndex >= 0)
+	{
+		aiMaterial* pMaterial = m_pScene->mMaterials[vMesh->mMaterialIndex];
+
+		std::vector<STextureInfo> DiffuseMaps = __loadMaterialTextures(pMaterial, aiTextureType_DIFFUSE, "uMaterialDiffuseTex");
+		Textures.insert(Textures.end(), DiffuseMaps.begin(), DiffuseMaps.end());
+
+		std::vector<STextureInfo> SpecularMaps = __loadMaterialTextures(pMaterial, aiTextureType_SPECULAR, "uMaterialSpecularTex");
+		Textures.insert(Textures.end(), SpecularMaps.begin(), SpecularMaps.end());
+
+		aiColor4D DiffuseColor;
+		aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_DIFFUSE, &DiffuseColor);
+		Uniforms.push_back(SUniformInfo{ EUniformType::VEC3F, "uMaterialDiffuse", std::any(glm::vec3(DiffuseColor.r, DiffuseColor.g, DiffuseColor.b)) });
+
+		aiColor4D SpecularColor;
+		aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_DIFFUSE, &SpecularColor);
+		Uniforms.push_back(SUniformInfo{ EUniformType::VEC3F, "uMaterialSpecular", std::any(glm::vec3(SpecularColor.r, SpecularColor.g, SpecularColor.b)) });
+	}
+
+	MeshData.AABB.Max = aiVector3ToGlm(&(vMesh->mAABB.mMax));
+	MeshData.AABB.Min = aiVector3ToGlm(&(vMesh->mAABB.mMin));
+
+	return MeshData;
+}
+
+//**********************************************************************************************
+//FUNCTION: Assimp hands out one vertex per face corner in source order, so weld and reorder the meshes before they are
+//          cached and uploaded
+void CModelAsset::__optimizeMeshes(std::vector<SMeshData>& vioMeshes) const
+{
+	CCPUTimer Timer;
+	Timer.start();
+
+	SMeshStatistics Before, After;
+	for (auto& Mesh : vioMeshes)
+	{
+		Before += CMeshOptimizer::analyze(Mesh, false);
+		CMeshOptimizer::optimize(Mesh, m_Options.OptimizeOverdraw);
+		After += CMeshOptimizer::analyze(Mesh, true);
+	}
+
+	Timer.stop();
+	_OUTPUT_EVENT(format("Optimized model %s in %.2f ms: %u -> %u vertices (%.2f -> %.2f MB), %u -> %u indices (%.2f -> %.2f MB), ACMR %.3f -> %.3f",
+		m_FilePath.c_str(), Timer.getElapsedTimeInMS(), Before.NumVertices, After.NumVertices, Before.VertexMemorySize / (1024.0 * 1024.0), After.VertexMemorySize / (1024.0 * 1024.0),
+		Before.NumIndices, After.NumIndices, Before.IndexMemorySize / (1024.0 * 1024.0), After.IndexMemorySize / (1024.0 * 1024.0), Before.getACMR(), After.getACMR()));
+}
+
+//**********************************************************************************************
+//FUNCTION: the simplifier locks the vertices on open edges, and without welding every corner of Assimp's output is its
+//          own vertex, so meshes that were not optimized are welded first
+void CModelAsset::__generateLODs(std::vector<SMeshData>& vioMeshes) const
+{
+	CCPUTimer Timer;
+	Timer.start();
+
+	unsigned NumMeshesWithoutLOD = 0;
+	std::vector<unsigned> NumTrianglesPerLOD(NUM_GENERATED_LODS + 1, 0);
+	for (auto& Mesh : vioMeshes)
+	{
+		if (!m_Options.OptimizeMeshes) CMeshOptimizer::weldVertices(Mesh.Vertices, Mesh.Indices);
+		CMeshSimplifier::generateLODs(Mesh, NUM_GENERATED_LODS);
+		if (Mesh.LODs.empty()) ++NumMeshesWithoutLOD;
+
+		NumTrianglesPerLOD[0] += static_cast<unsigned>(Mesh.Indices.size() / 3);
+		for (unsigned i = 1; i <= NUM_GENERATED_LODS; ++i)
+			NumTrianglesPerLOD[i] += static_cast<unsigned>(((i <= Mesh.LODs.size()) ? Mesh.LODs[i - 1].size() : (Mesh.LODs.empty() ? Mesh.Indices.size() : Mesh.LODs.back().size())) / 3);
+	}
+
+	std::string Triangles;
+	for (auto NumTriangles : NumTrianglesPerLOD) Triangles += (Triangles.empty() ? "" : " / ") + std::to_string(NumTriangles);
+
+	Timer.stop();
+	_OUTPUT_EVENT(format("Generated LODs of model %s in %.2f ms: %s triangles", m_FilePath.c_str(), Timer.getElapsedTimeInMS(), Triangles.c_str()));
+	if (NumMeshesWithoutLOD > 0) _OUTPUT_WARNING(format("%u of %u meshes of model %s got no LOD levels", NumMeshesWithoutLOD, static_cast<unsigned>(vioMeshes.size()), m_FilePath.c_str()));
+}
+
+//**********************************************************************************************
+//FUNCTION: part of the mesh cache key, a cache written with other optimization options is rebuilt
+unsigned CModelAsset::__getOptimizationFlags() const
+{
+	unsigned Flags = 0;
+	if (m_Options.OptimizeMeshes) Flags |= OPTIMIZE_MESH_FLAG;
+	if (m_Options.OptimizeMeshes && m_Options.OptimizeOverdraw) Flags |= OPTIMIZE_OVERDRAW_FLAG;
+	if (m_Options.GenerateLODs) Flags |= GENERATE_LOD_FLAG;
+	return Flags;
+}
+
+//**********************************************************************************************
+//FUNCTION:
+std::vector<STextureInfo> CModelAsset::__loadMaterialTextures(const aiMaterial* vMat, aiTextureType vType, const std::string& vTypeName)
+{
+	std::vector<STextureInfo> Textures;
+	for (GLuint i = 0; i < vMat->GetTextureCount(vType); ++i)
+	{
+		aiString Str;
+		vMat->GetTexture(vType, i, &Str);
+		Textures.push_back(STextureInfo{ vTypeName, this->m_Directory + std::string("/") + std::string(Str.C_Str()) });
+	}
+	return Textures;
+}
+
+//**********************************************************************************************
+//FUNCTION:
+SMeshPart CModelAsset::__createMeshPart(const SVertex* vVertices, unsigned vNumVertices, const unsigned* vIndices, unsigned vNumIndices,
+	const std::vector<STextureInfo>& vTextures, const std::vector<SUniformInfo>& vUniforms, const SAABB& vAABB, const std::vector<SMeshLOD>& vLODs)
+{
+	std::vector<SMeshTexture> Textures;
+	for (const auto& TextureInfo : vTextures) Textures.push_back(SMeshTexture{ TextureInfo.Name, __loadTexture(TextureInfo) });
+
+	return SMeshPart{ vVertices, vNumVertices, vIndices, vNumIndices, Textures, vUniforms, vAABB, vLODs };
+}
+
+//**********************************************************************************************
+//FUNCTION:
+std::shared_ptr<CTexture2D> CModelAsset::__loadTexture(const STextureInfo& vTextureInfo)
+{
+	return CTextureCache::getInstance()->loadTexture2D(vTextureInfo.FilePath, GL_REPEAT, GL_LINEAR, false, m_Options.StreamTextures);
+}
+
+//***********************************************************************************************
+//FUNCTION: vSkinnedMeshes holds the skinned vertices of one instance per mesh, meshes without skin have none
+void CModelAsset::_draw(const CShaderProgram& vShaderProgram, EVertexInput vVertexInput, unsigned vLOD, const std::vector<SSkinnedVertices>* vSkinnedMeshes,
+	unsigned vNumInstances, SBindState* vioBindState) const
+{
+	for (unsigned i = 0; i < getNumMeshes(); ++i) _drawMesh(i, vShaderProgram, vVertexInput, vLOD, vSkinnedMeshes, vNumInstances, vioBindState);
+}
+
+//***********************************************************************************************
+//FUNCTION:
+void CModelAsset::_drawMesh(unsigned vMeshIndex, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput, unsigned vLOD, const std::vector<SSkinnedVertices>* vSkinnedMeshes,
+	unsigned vNumInstances, SBindState* vioBindState, const unsigned char* vPartVisibility) const
+{
+	_ASSERTE(vMeshIndex < m_Meshes.size());
+	const SSkinnedVertices* pSkinnedVertices = (vSkinnedMeshes && vMeshIndex < vSkinnedMeshes->size()) ? &(*vSkinnedMeshes)[vMeshIndex] : nullptr;
+	m_Meshes[vMeshIndex]->_draw(vShaderProgram, vVertexInput, vLOD, pSkinnedVertices, vNumInstances, vioBindState, vPartVisibility);
+}
+
+//***********************************************************************************************
+//FUNCTION: skins every skinned mesh of one instance into its own vertices, which are created on first use. Returns the
+//          number of vertices skinned
+unsigned CModelAsset::_skin(const CShaderProgram& vSkinningProgram, std::vector<SSkinnedVertices>& vioSkinnedMeshes) const
+{
+	vioSkinnedMeshes.resize(m_Meshes.size());
+
+	unsigned NumVertices = 0;
+	for (size_t i = 0; i < m_Meshes.size(); ++i)
+	{
+		if (!m_Meshes[i]->hasSkin()) continue;
+		if (!vioSkinnedMeshes[i].pBuffer) m_Meshes[i]->_createSkinnedVertices(vioSkinnedMeshes[i]);
+
+		m_Meshes[i]->_skin(vSkinningProgram, vioSkinnedMeshes[i]);
+		NumVertices += m_Meshes[i]->getNumVertices();
+	}
+
+	return NumVertices;
+}
+
+//***********************************************************************************************
+//FUNCTION: only reads the asset, so the poses of instances sharing it can be evaluated on different threads as long as
+//          each one brings its own workspace
+void CModelAsset::_boneTransform(unsigned vClipIndex, float vTimeInSeconds, std::vector<glm::mat4>& voTransforms, SPoseWorkspace& vioWorkspace) const
+{
+	_ASSERTE(vClipIndex < m_Clips.size());
+	m_Skeleton.evaluatePose(m_Clips[vClipIndex], vTimeInSeconds, vioWorkspace, voTransforms);
+}
+
+//***********************************************************************************************
+//FUNCTION: copies the clips out of the aiScene, compiles the node hierarchy and compresses the clips against it. Channels
+//          of all clips animating the same node share one channel index, a clip not animating that node leaves its
+//          channel empty
+void CModelAsset::__loadAnimations()
+{
+	for (unsigned i = 0; i < m_pScene->mNumAnimations; ++i)
+	{
+		const aiAnimation* pAnimation = m_pScene->mAnimations[i];
+		for (unsigned k = 0; k < pAnimation->mNumChannels; ++k)
+			m_NodeName2ChannelMap.emplace(pAnimation->mChannels[k]->mNodeName.data, static_cast<unsigned>(m_NodeName2ChannelMap.size()));
+	}
+
+	std::vector<SSkeletonNode> Nodes;
+	__buildSkeleton(m_pScene->mRootNode, -1, Nodes);
+	m_Skeleton = CSkeleton(Nodes, m_BoneOffsets, m_GlobalInverseTransform);
+
+	for (unsigned i = 0; i < m_pScene->mNumAnimations; ++i)
+	{
+		const aiAnimation* pAnimation = m_pScene->mAnimations[i];
+
+		SRawAnimationClip Clip;
+		Clip.Name = pAnimation->mName.data;
+		Clip.Duration = static_cast<float>(pAnimation->mDuration);
+		Clip.TicksPerSecond = pAnimation->mTicksPerSecond != 0 ? static_cast<float>(pAnimation->mTicksPerSecond) : 25.0f;
+		Clip.Channels.resize(m_NodeName2ChannelMap.size());
+
+		for (unsigned k = 0; k < pAnimation->mNumChannels; ++k)
+		{
+			const aiNodeAnim* pNodeAnim = pAnimation->mChannels[k];
+			SRawAnimationChannel& Channel = Clip.Channels[m_NodeName2ChannelMap.at(pNodeAnim->mNodeName.data)];
+
+			for (unsigned m = 0; m < pNodeAnim->mNumPositionKeys; ++m)
+			{
+				const aiVectorKey& Key = pNodeAnim->mPositionKeys[m];
+				Channel.PositionKeys.push_back(SVectorKey{ static_cast<float>(Key.mTime), glm::vec3(Key.mValue.x, Key.mValue.y, Key.mValue.z) });
+			}
+			for (unsigned m = 0; m < pNodeAnim->mNumRotationKeys; ++m)
+			{
+				const aiQuatKey& Key = pNodeAnim->mRotationKeys[m];
+				Channel.RotationKeys.push_back(SRotationKey{ static_cast<float>(Key.mTime), glm::quat(Key.mValue.w, Key.mValue.x, Key.mValue.y, Key.mValue.z) });
+			}
+			for (unsigned m = 0; m < pNodeAnim->mNumScalingKeys; ++m)
+			{
+				const aiVectorKey& Key = pNodeAnim->mScalingKeys[m];
+				Channel.ScalingKeys.push_back(SVectorKey{ static_cast<float>(Key.mTime), glm::vec3(Key.mValue.x, Key.mValue.y, Key.mValue.z) });
+			}
+
+			if (Channel.PositionKeys.empty()) Channel.PositionKeys.push_back(SVectorKey{ 0.0f, glm::vec3(0.0f) });
+			if (Channel.RotationKeys.empty()) Channel.RotationKeys.push_back(SRotationKey{ 0.0f, glm::quat(1.0f, 0.0f, 0.0f, 0.0f) });
+			if (Channel.ScalingKeys.empty()) Channel.ScalingKeys.push_back(SVectorKey{ 0.0f, glm::vec3(1.0f) });
+		}
+
+		SAnimationCompressionReport Report;
+		m_Clips.push_back(CAnimationCompressor::compress(Clip, Nodes, SAnimationCompressionOptions(), Report));
+
+		_OUTPUT_EVENT(format("Compressed clip %s: %u -> %u keys, %.1f KB -> %.1f KB, max joint error %g", Clip.Name.c_str(), Report.NumRawKeys, Report.NumKeys,
+			Report.RawMemorySize / 1024.0, Report.MemorySize / 1024.0, Report.MaxJointError));
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION: a pre-order walk, so every node lands behind its parent
+void CModelAsset::__buildSkeleton(const aiNode* vNode, int vParent, std::vector<SSkeletonNode>& vioNodes) const
+{
+	SSkeletonNode Node;
+	Node.Parent = vParent;
+	Node.Transform = aiMatrix4x4ToGlm(&(vNode->mTransformation));
+
+	auto ChannelIter = m_NodeName2ChannelMap.find(vNode->mName.data);
+	if (ChannelIter != m_NodeName2ChannelMap.end()) Node.Channel = static_cast<int>(ChannelIter->second);
+	auto BoneIter = m_BoneName2IndexMap.find(vNode->mName.data);
+	if (BoneIter != m_BoneName2IndexMap.end()) Node.Bone = static_cast<int>(BoneIter->second);
+
+	int Index = static_cast<int>(vioNodes.size());
+	vioNodes.push_back(Node);
+
+	for (unsigned i = 0; i < vNode->mNumChildren; ++i) __buildSkeleton(vNode->mChildren[i], Index, vioNodes);
+}
+
+//***********************************************************************************************
+//FUNCTION: thread-safe, the caller creating the asset is responsible for importing and uploading it
+std::shared_ptr<CModelAsset> CModelAssetRegistry::getOrCreateAsset(const std::string& vFilePath, const SModelLoadOptions& vOptions, bool& voIsCreated)
+{
+	std::string Key = __getAssetKey(vFilePath, vOptions);
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	std::shared_ptr<CModelAsset> pAsset = m_AssetMap[Key].lock();
+	voIsCreated = (pAsset == nullptr);
+	if (voIsCreated)
+	{
+		pAsset = std::make_shared<CModelAsset>(vFilePath, vOptions);
+		m_AssetMap[Key] = pAsset;
+	}
+
+	return pAsset;
+}
+
+//***********************************************************************************************
+//FUNCTION: called when importing the asset failed, so the next request for the file imports it again instead of sharing
+//          the empty asset
+void CModelAssetRegistry::removeFailedAsset(const std::shared_ptr<CModelAsset>& vAsset)
+{
+	_ASSERTE(vAsset);
+	std::string Key = __getAssetKey(vAsset->getFilePath(), vAsset->getOptions());
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	auto Iter = m_AssetMap.find(Key);
+	if (Iter != m_AssetMap.end() && Iter->second.lock() == vAsset) m_AssetMap.erase(Iter);
+}
+
+//***********************************************************************************************
+//FUNCTION:
+size_t CModelAssetRegistry::getNumAssets() const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	size_t NumAssets = 0;
+	for (const auto& Pair : m_AssetMap) NumAssets += Pair.second.expired() ? 0 : 1;
+	return NumAssets;
+}
+
+//***********************************************************************************************
+//FUNCTION: the same file loaded with different options ends up in different GPU buffers, so the options are part of the key
+std::string CModelAssetRegistry::__getAssetKey(const std::string& vFilePath, const SModelLoadOptions& vOptions)
+{
+	return format("%s|%d%d%d%d%d%d", vFilePath.c_str(), vOptions.StreamTextures, vOptions.PackVertices, vOptions.OptimizeMeshes, vOptions.OptimizeOverdraw,
+		vOptions.MergeMeshBuffers, vOptions.GenerateLODs);
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <assimp/scene.h>
+#include "Mesh.h"
+#include "Skeleton.h"
+#include "Common.h"
+#include "Export.h"
+
+namespace glt
+{
+	//NOTE: a model loaded with PackVertices can only be drawn by vertex shaders that read positions and normals through
+	//      fetchVertexPosition and fetchVertexNormal of vertex_attributes.glsl
+	struct SModelLoadOptions
+	{
+		bool StreamTextures = false;
+		bool PackVertices = false;
+		bool OptimizeMeshes = true;
+		bool OptimizeOverdraw = false;
+		bool MergeMeshBuffers = false;
+		bool GenerateLODs = false;
+	};
+
+	class CShaderProgram;
+	class CTexture2D;
+	class CModelCache;
+
+	//NOTE: the geometry, textures, skeleton and animations loaded from one file. The asset does not change after it
+	//      has been uploaded and is shared by all the CModel instances placed from that file
+	class GLT_DECLSPEC CModelAsset
+	{
+	public:
+		CModelAsset(const std::string& vFilePath, const SModelLoadOptions& vOptions);
+		~CModelAsset();
+
+		const std::string& getFilePath() const { return m_FilePath; }
+		const SModelLoadOptions& getOptions() const { return m_Options; }
+		bool isUploaded() const { return m_IsUploaded; }
+		bool hasBones() const { return m_HasBones; }
+		unsigned getNumAnimationClips() const { return static_cast<unsigned>(m_Clips.size()); }
+		const SAnimationClip& getAnimationClip(unsigned vIndex) const { _ASSERTE(vIndex < m_Clips.size()); return m_Clips[vIndex]; }
+		const CSkeleton& getSkeleton() const { return m_Skeleton; }
+		unsigned getNumMeshes() const { return static_cast<unsigned>(m_Meshes.size()); }
+		const CMesh& getMesh(unsigned vIndex) const { _ASSERTE(vIndex < m_Meshes.size()); return *m_Meshes[vIndex]; }
+
+		SAABB getAABB() const;
+		size_t getVertexMemorySize() const;
+		size_t getIndexMemorySize() const;
+		unsigned getNumDrawCalls() const;
+		unsigned getNumLODs() const;
+		unsigned getNumTriangles(unsigned vLOD = 0) const;
+
+	protected:
+		bool _import();
+		void _upload();
+
+		void _draw(const CShaderProgram& vShaderProgram, EVertexInput vVertexInput = EVertexInput::Full, unsigned vLOD = 0,
+			const std::vector<SSkinnedVertices>* vSkinnedMeshes = nullptr, unsigned vNumInstances = 1, SBindState* vioBindState = nullptr) const;
+		void _drawMesh(unsigned vMeshIndex, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput = EVertexInput::Full, unsigned vLOD = 0,
+			const std::vector<SSkinnedVertices>* vSkinnedMeshes = nullptr, unsigned vNumInstances = 1, SBindState* vioBindState = nullptr,
+			const unsigned char* vPartVisibility = nullptr) const;
+		unsigned _skin(const CShaderProgram& vSkinningProgram, std::vector<SSkinnedVertices>& vioSkinnedMeshes) const;
+		void _boneTransform(unsigned vClipIndex, float vTimeInSeconds, std::vector<glm::mat4>& voTransforms, SPoseWorkspace& vioWorkspace) const;
+
+	private:
+		_DISALLOW_COPY_AND_ASSIGN(CModelAsset);
+
+		void __processNode(const aiNode* vNode, std::vector<SMeshData>& voMeshes);
+		SMeshData __processMesh(const aiMesh* vMesh);
+		void __optimizeMeshes(std::vector<SMeshData>& vioMeshes) const;
+		void __generateLODs(std::vector<SMeshData>& vioMeshes) const;
+		unsigned __getOptimizationFlags() const;
+		std::vector<STextureInfo> __loadMaterialTextures(const aiMaterial* vMat, aiTextureType vType, const std::string& vTypeName);
+		SMeshPart __createMeshPart(const SVertex* vVertices, unsigned vNumVertices, const unsigned* vIndices, unsigned vNumIndices,
+			const std::vector<STextureInfo>& vTextures, const std::vector<SUniformInfo>& vUniforms, const SAABB& vAABB, const std::vector<SMeshLOD>& vLODs);
+		std::shared_ptr<CTexture2D> __loadTexture(const STextureInfo& vTextureInfo);
+
+		void __loadAnimations();
+		void __buildSkeleton(const aiNode* vNode, int vParent, std::vector<SSkeletonNode>& vioNodes) const;
+
+		std::vector<std::shared_ptr<CMesh>> m_Meshes;
+
+		//NOTE: the scene only lives while the file is imported, it is owned by the importer local to _import
+		const aiScene* m_pScene = nullptr;
+		std::string m_FilePath;
+		std::string m_Directory;
+		SModelLoadOptions m_Options;
+		bool m_IsUploaded = false;
+
+		std::vector<SMeshData>			m_PendingMeshes;
+		std::shared_ptr<CModelCache>	m_pPendingCache;
+
+		std::unordered_map<std::string, unsigned>	m_BoneName2IndexMap;
+		std::unordered_map<std::string, unsigned>	m_NodeName2ChannelMap;
+		std::vector<glm::mat4>						m_BoneOffsets;
+		unsigned	m_NumBones = 0;
+		bool		m_HasBones = false;
+		glm::mat4	m_GlobalInverseTransform;
+
+		CSkeleton					m_Skeleton;
+		std::vector<SAnimationClip>	m_Clips;
+
+		friend class CModel;
+		friend class CScene;
+	};
+
+	//NOTE: hands out the asset of a file if some model still holds it, the registry itself only keeps weak references
+	class GLT_DECLSPEC CModelAssetRegistry
+	{
+	public:
+		_SINGLETON(CModelAssetRegistry);
+
+		std::shared_ptr<CModelAsset> getOrCreateAsset(const std::string& vFilePath, const SModelLoadOptions& vOptions, bool& voIsCreated);
+		void removeFailedAsset(const std::shared_ptr<CModelAsset>& vAsset);
+		size_t getNumAssets() const;
+
+	private:
+		CModelAssetRegistry() = default;
+
+		static std::string __getAssetKey(const std::string& vFilePath, const SModelLoadOptions& vOptions);
+
+		std::unordered_map<std::string, std::weak_ptr<CModelAsset>> m_AssetMap;
+		mutable std::mutex m_Mutex;
+	};
+}
\ No newline at end of file
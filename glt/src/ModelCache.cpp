@@ -0,0 +1,288 @@
+#include "ModelCache.h"
+#include <fstream>
+#include <filesystem>
+#include <set>
+#include <cstring>
+
+using namespace glt;
+
+namespace
+{
+	constexpr unsigned CACHE_MAGIC = 0x43544C47; //"GLTC"
+	constexpr unsigned CACHE_VERSION = 4;
+	constexpr size_t BLOB_ALIGNMENT = 16;
+
+	class CCacheWriter
+	{
+	public:
+		CCacheWriter(std::ofstream& vStream) : m_Stream(vStream) {}
+
+		template <typename T> void write(const T& vValue) { writeBytes(&vValue, sizeof(T)); }
+
+		void writeBytes(const void* vData, size_t vSize)
+		{
+			m_Stream.write(static_cast<const char*>(vData), vSize);
+			m_Offset += vSize;
+		}
+
+		void writeString(const std::string& vString)
+		{
+			write<unsigned>(static_cast<unsigned>(vString.size()));
+			writeBytes(vString.data(), vString.size());
+		}
+
+		void align()
+		{
+			static const char Padding[BLOB_ALIGNMENT] = {};
+			size_t Remainder = m_Offset % BLOB_ALIGNMENT;
+			if (Remainder != 0) writeBytes(Padding, BLOB_ALIGNMENT - Remainder);
+		}
+
+	private:
+		std::ofstream& m_Stream;
+		size_t m_Offset = 0;
+	};
+
+	class CCacheReader
+	{
+	public:
+		CCacheReader(const unsigned char* vData, size_t vSize) : m_pData(vData), m_Size(vSize) {}
+
+		bool isValid() const { return m_IsValid; }
+
+		template <typename T> T read()
+		{
+			T Value{};
+			const void* pSource = readBytes(sizeof(T));
+			if (pSource) std::memcpy(&Value, pSource, sizeof(T));
+			return Value;
+		}
+
+		const void* readBytes(size_t vSize)
+		{
+			if (!m_IsValid || m_Offset + vSize > m_Size) { m_IsValid = false; return nullptr; }
+			const void* pResult = m_pData + m_Offset;
+			m_Offset += vSize;
+			return pResult;
+		}
+
+		std::string readString()
+		{
+			unsigned Length = read<unsigned>();
+			const char* pChars = static_cast<const char*>(readBytes(Length));
+			return pChars ? std::string(pChars, Length) : std::string();
+		}
+
+		void align()
+		{
+			size_t Remainder = m_Offset % BLOB_ALIGNMENT;
+			if (Remainder != 0) readBytes(BLOB_ALIGNMENT - Remainder);
+		}
+
+	private:
+		const unsigned char* m_pData = nullptr;
+		size_t m_Size = 0;
+		size_t m_Offset = 0;
+		bool m_IsValid = true;
+	};
+}
+
+//***********************************************************************************************
+//FUNCTION: the cache is rejected when its format, vertex layout, import/optimization flags or the timestamp of the source or
+//          of any dependency do not match
+bool CModelCache::load(const std::string& vSourcePath, unsigned vImportFlags, unsigned vOptimizationFlags)
+{
+	m_Meshes.clear();
+
+	long long SourceTimestamp = __getSourceTimestamp(vSourcePath);
+	if (SourceTimestamp == 0 || !m_File.open(getCacheFilePath(vSourcePath))) return false;
+
+	CCacheReader Reader(m_File.getData(), m_File.getSize());
+	if (Reader.read<unsigned>() != CACHE_MAGIC || Reader.read<unsigned>() != CACHE_VERSION || Reader.read<unsigned>() != sizeof(SVertex)
+		|| Reader.read<unsigned>() != vImportFlags || Reader.read<unsigned>() != vOptimizationFlags
+		|| Reader.read<long long>() != SourceTimestamp || Reader.readString() != vSourcePath)
+	{
+		m_File.close();
+		return false;
+	}
+
+	unsigned NumDependencies = Reader.read<unsigned>();
+	for (unsigned i = 0; i < NumDependencies && Reader.isValid(); ++i)
+	{
+		std::string Dependency = Reader.readString();
+		if (Reader.read<long long>() != __getSourceTimestamp(Dependency))
+		{
+			m_File.close();
+			return false;
+		}
+	}
+
+	m_ImportTimeInMS = Reader.read<double>();
+
+	unsigned NumMeshes = Reader.read<unsigned>();
+	for (unsigned i = 0; i < NumMeshes && Reader.isValid(); ++i)
+	{
+		SMeshView Mesh;
+		Mesh.NumVertices = Reader.read<unsigned>();
+		Mesh.NumIndices = Reader.read<unsigned>();
+		Mesh.AABB = Reader.read<SAABB>();
+
+		unsigned NumTextures = Reader.read<unsigned>();
+		for (unsigned k = 0; k < NumTextures && Reader.isValid(); ++k)
+		{
+			STextureInfo Texture;
+			Texture.Name = Reader.readString();
+			Texture.FilePath = Reader.readString();
+			Mesh.Textures.push_back(Texture);
+		}
+
+		unsigned NumUniforms = Reader.read<unsigned>();
+		for (unsigned k = 0; k < NumUniforms && Reader.isValid(); ++k)
+		{
+			EUniformType Type = Reader.read<EUniformType>();
+			std::string Name = Reader.readString();
+			glm::vec4 Value = Reader.read<glm::vec4>();
+
+			switch (Type)
+			{
+			case EUniformType::FLOAT: Mesh.Uniforms.push_back(SUniformInfo{ Type, Name, std::any(Value.x) }); break;
+			case EUniformType::VEC2F: Mesh.Uniforms.push_back(SUniformInfo{ Type, Name, std::any(glm::vec2(Value.x, Value.y)) }); break;
+			case EUniformType::VEC3F: Mesh.Uniforms.push_back(SUniformInfo{ Type, Name, std::any(glm::vec3(Value)) }); break;
+			case EUniformType::VEC4F: Mesh.Uniforms.push_back(SUniformInfo{ Type, Name, std::any(Value) }); break;
+			default: break;
+			}
+		}
+
+		Reader.align();
+		Mesh.pVertices = static_cast<const SVertex*>(Reader.readBytes(Mesh.NumVertices * sizeof(SVertex)));
+		Reader.align();
+		Mesh.pIndices = static_cast<const unsigned*>(Reader.readBytes(Mesh.NumIndices * sizeof(unsigned)));
+
+		unsigned NumLODs = Reader.read<unsigned>();
+		for (unsigned k = 0; k < NumLODs && Reader.isValid(); ++k)
+		{
+			SMeshLOD LOD;
+			LOD.NumIndices = Reader.read<unsigned>();
+			Reader.align();
+			LOD.pIndices = static_cast<const unsigned*>(Reader.readBytes(LOD.NumIndices * sizeof(unsigned)));
+			Mesh.LODs.push_back(LOD);
+		}
+
+		m_Meshes.push_back(Mesh);
+	}
+
+	if (!Reader.isValid())
+	{
+		_OUTPUT_WARNING(format("The model cache of %s is corrupted and will be rebuilt.", vSourcePath.c_str()));
+		m_Meshes.clear();
+		m_File.close();
+		return false;
+	}
+
+	return true;
+}
+
+//***********************************************************************************************
+//FUNCTION: written to a temporary file that replaces the cache only once complete, so an interrupted write never leaves
+//          a truncated cache behind. The textures of the meshes are dependencies as well, a missing one is recorded with
+//          timestamp 0 and invalidates the cache once it appears
+bool CModelCache::save(const std::string& vSourcePath, unsigned vImportFlags, unsigned vOptimizationFlags, const std::vector<SMeshData>& vMeshes,
+	const std::vector<std::string>& vDependencies, double vImportTimeInMS)
+{
+	long long SourceTimestamp = __getSourceTimestamp(vSourcePath);
+	if (SourceTimestamp == 0) return false;
+
+	std::set<std::string> Dependencies(vDependencies.begin(), vDependencies.end());
+	for (const auto& Mesh : vMeshes)
+		for (const auto& Texture : Mesh.Textures) Dependencies.insert(Texture.FilePath);
+	Dependencies.erase(vSourcePath);
+
+	std::string CacheFilePath = getCacheFilePath(vSourcePath);
+	std::string TemporaryFilePath = CacheFilePath + ".tmp";
+	std::ofstream Stream(TemporaryFilePath, std::ios::binary | std::ios::trunc);
+	_EARLY_RETURN(!Stream.is_open(), format("Failed to create model cache at %s.", TemporaryFilePath.c_str()), false);
+
+	CCacheWriter Writer(Stream);
+	Writer.write<unsigned>(CACHE_MAGIC);
+	Writer.write<unsigned>(CACHE_VERSION);
+	Writer.write<unsigned>(sizeof(SVertex));
+	Writer.write<unsigned>(vImportFlags);
+	Writer.write<unsigned>(vOptimizationFlags);
+	Writer.write<long long>(SourceTimestamp);
+	Writer.writeString(vSourcePath);
+
+	Writer.write<unsigned>(static_cast<unsigned>(Dependencies.size()));
+	for (const auto& Dependency : Dependencies)
+	{
+		Writer.writeString(Dependency);
+		Writer.write<long long>(__getSourceTimestamp(Dependency));
+	}
+
+	Writer.write<double>(vImportTimeInMS);
+
+	Writer.write<unsigned>(static_cast<unsigned>(vMeshes.size()));
+	for (const auto& Mesh : vMeshes)
+	{
+		Writer.write<unsigned>(static_cast<unsigned>(Mesh.Vertices.size()));
+		Writer.write<unsigned>(static_cast<unsigned>(Mesh.Indices.size()));
+		Writer.write<SAABB>(Mesh.AABB);
+
+		Writer.write<unsigned>(static_cast<unsigned>(Mesh.Textures.size()));
+		for (const auto& Texture : Mesh.Textures)
+		{
+			Writer.writeString(Texture.Name);
+			Writer.writeString(Texture.FilePath);
+		}
+
+		Writer.write<unsigned>(static_cast<unsigned>(Mesh.Uniforms.size()));
+		for (const auto& Uniform : Mesh.Uniforms)
+		{
+			glm::vec4 Value(0.0f);
+			switch (Uniform.Type)
+			{
+			case EUniformType::FLOAT: Value.x = std::any_cast<float>(Uniform.Value); break;
+			case EUniformType::VEC2F: Value = glm::vec4(std::any_cast<glm::vec2>(Uniform.Value).x, std::any_cast<glm::vec2>(Uniform.Value).y, 0.0f, 0.0f); break;
+			case EUniformType::VEC3F: Value = glm::vec4(std::any_cast<glm::vec3>(Uniform.Value), 0.0f); break;
+			case EUniformType::VEC4F: Value = std::any_cast<glm::vec4>(Uniform.Value); break;
+			default: break;
+			}
+
+			Writer.write<EUniformType>(Uniform.Type);
+			Writer.writeString(Uniform.Name);
+			Writer.write<glm::vec4>(Value);
+		}
+
+		Writer.align();
+		Writer.writeBytes(Mesh.Vertices.data(), Mesh.Vertices.size() * sizeof(SVertex));
+		Writer.align();
+		Writer.writeBytes(Mesh.Indices.data(), Mesh.Indices.size() * sizeof(unsigned));
+
+		Writer.write<unsigned>(static_cast<unsigned>(Mesh.LODs.size()));
+		for (const auto& LOD : Mesh.LODs)
+		{
+			Writer.write<unsigned>(static_cast<unsigned>(LOD.size()));
+			Writer.align();
+			Writer.writeBytes(LOD.data(), LOD.size() * sizeof(unsigned));
+		}
+	}
+
+	Stream.close();
+	std::error_code ErrorCode;
+	if (Stream.good()) std::filesystem::rename(TemporaryFilePath, CacheFilePath, ErrorCode);
+	if (!Stream.good() || ErrorCode)
+	{
+		std::filesystem::remove(TemporaryFilePath, ErrorCode);
+		_OUTPUT_WARNING(format("Failed to write model cache at %s.", CacheFilePath.c_str()));
+		return false;
+	}
+	return true;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+long long CModelCache::__getSourceTimestamp(const std::string& vSourcePath)
+{
+	std::error_code ErrorCode;
+	auto WriteTime = std::filesystem::last_write_time(vSourcePath, ErrorCode);
+	return ErrorCode ? 0 : static_cast<long long>(WriteTime.time_since_epoch().count());
+}
\ No newline at end of file
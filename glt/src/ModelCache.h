@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Mesh.h"
+#include "MappedFile.h"
+#include "Export.h"
+
+namespace glt
+{
+	struct SMeshView
+	{
+		const SVertex* pVertices = nullptr;
+		unsigned NumVertices = 0;
+		const unsigned* pIndices = nullptr;
+		unsigned NumIndices = 0;
+		std::vector<STextureInfo> Textures;
+		std::vector<SUniformInfo> Uniforms;
+		SAABB AABB;
+		std::vector<SMeshLOD> LODs;
+	};
+
+	//NOTE: the cache file lives next to the source model, its vertex and index blobs are memory mapped
+	//      and handed to the GPU without any intermediate copy. Besides the source model the cache records the timestamps
+	//      of the files it depends on, such as material libraries and textures
+	class GLT_DECLSPEC CModelCache
+	{
+	public:
+		CModelCache() = default;
+		~CModelCache() = default;
+
+		bool load(const std::string& vSourcePath, unsigned vImportFlags, unsigned vOptimizationFlags);
+		static bool save(const std::string& vSourcePath, unsigned vImportFlags, unsigned vOptimizationFlags, const std::vector<SMeshData>& vMeshes,
+			const std::vector<std::string>& vDependencies, double vImportTimeInMS);
+
+		static std::string getCacheFilePath(const std::string& vSourcePath) { return vSourcePath + ".gltcache"; }
+
+		const std::vector<SMeshView>& getMeshes() const { return m_Meshes; }
+		double getImportTime() const { return m_ImportTimeInMS; }
+
+	private:
+		_DISALLOW_COPY_AND_ASSIGN(CModelCache);
+
+		static long long __getSourceTimestamp(const std::string& vSourcePath);
+
+		CMappedFile m_File;
+		std::vector<SMeshView> m_Meshes;
+		double m_ImportTimeInMS = 0.0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include <glad/glad.h>
+#include "Export.h"
+
+namespace glt
+{
+	class CShaderProgram;
+
+	//NOTE: the fixed function state a pipeline state sets, the defaults are the state CRenderer::init leaves behind
+	struct SRasterState
+	{
+		bool IsBlendEnabled = false;
+		GLenum BlendSrcFactor = GL_ONE;
+		GLenum BlendDstFactor = GL_ZERO;
+		bool IsDepthTestEnabled = true;
+		bool IsDepthWriteEnabled = true;
+		GLenum DepthFunc = GL_LESS;
+		bool IsCullFaceEnabled = true;
+		GLenum CullFaceMode = GL_BACK;
+	};
+
+	//NOTE: the blend, depth, cull and program state of a pass, fixed once created. Applying it only issues the calls for
+	//      what differs from the state the renderer knows to be current. The program is optional and must outlive the
+	//      pipeline state
+	class GLT_DECLSPEC CPipelineState
+	{
+	public:
+		CPipelineState(const SRasterState& vRasterState, const CShaderProgram* vShaderProgram = nullptr) : m_RasterState(vRasterState), m_pShaderProgram(vShaderProgram) {}
+		~CPipelineState() = default;
+
+		const SRasterState& getRasterState() const { return m_RasterState; }
+		const CShaderProgram* getShaderProgram() const { return m_pShaderProgram; }
+
+	private:
+		const SRasterState m_RasterState;
+		const CShaderProgram* const m_pShaderProgram;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+using namespace glt;
+
+namespace
+{
+	constexpr unsigned RADIX_BITS = 8;
+	constexpr unsigned RADIX_SIZE = 1u << RADIX_BITS;
+	constexpr unsigned long long RADIX_MASK = RADIX_SIZE - 1;
+}
+
+//***********************************************************************************************
+//FUNCTION: vDepth is the distance in [0, 1] from the camera, nearer commands sort first within the same state
+unsigned long long CRenderQueue::computeSortKey(unsigned vPass, unsigned vProgram, unsigned vMaterial, unsigned vVertexArray, float vDepth)
+{
+	unsigned long long Depth = static_cast<unsigned long long>(std::clamp(vDepth, 0.0f, 1.0f) * 65535.0f);
+
+	return (static_cast<unsigned long long>(vPass & 0xf) << 60) | (static_cast<unsigned long long>(vProgram & 0xfff) << 48)
+		| (static_cast<unsigned long long>(vMaterial & 0xffff) << 32) | (static_cast<unsigned long long>(vVertexArray & 0xffff) << 16) | Depth;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+unsigned CRenderQueue::addUniformSet(const std::vector<SUniformInfo>& vUniforms)
+{
+	m_UniformSets.push_back(vUniforms);
+	return static_cast<unsigned>(m_UniformSets.size() - 1);
+}
+
+//***********************************************************************************************
+//FUNCTION: the visibility of the parts of a merged mesh as culled when the command was recorded, one entry per part
+unsigned CRenderQueue::addPartVisibility(const unsigned char* vPartVisibility, unsigned vNumParts)
+{
+	unsigned Offset = static_cast<unsigned>(m_PartVisibilities.size());
+	m_PartVisibilities.insert(m_PartVisibilities.end(), vPartVisibility, vPartVisibility + vNumParts);
+	return Offset;
+}
+
+//***********************************************************************************************
+//FUNCTION: a least significant digit radix sort over the keys, one byte per pass. A pass in which all keys share the
+//          byte is skipped, which leaves few passes since most of a frame's commands share pass and program. The sort is
+//          stable, commands with equal keys keep the order they were recorded in
+void CRenderQueue::sort()
+{
+	size_t NumCommands = m_Commands.size();
+	m_SortEntries.resize(NumCommands);
+	m_SortBuffer.resize(NumCommands);
+	for (size_t i = 0; i < NumCommands; ++i) m_SortEntries[i] = { m_Commands[i].SortKey, static_cast<unsigned>(i) };
+	if (NumCommands <= 1) return;
+
+	for (unsigned Shift = 0; Shift < 64; Shift += RADIX_BITS)
+	{
+		size_t Offsets[RADIX_SIZE] = {};
+		for (const auto& Entry : m_SortEntries) Offsets[(Entry.Key >> Shift) & RADIX_MASK]++;
+		if (Offsets[(m_SortEntries[0].Key >> Shift) & RADIX_MASK] == NumCommands) continue;
+
+		size_t Sum = 0;
+		for (auto& Offset : Offsets)
+		{
+			size_t Count = Offset;
+			Offset = Sum;
+			Sum += Count;
+		}
+
+		for (const auto& Entry : m_SortEntries) m_SortBuffer[Offsets[(Entry.Key >> Shift) & RADIX_MASK]++] = Entry;
+		m_SortEntries.swap(m_SortBuffer);
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION: keeps the capacity for the next frame
+void CRenderQueue::clear()
+{
+	m_Commands.clear();
+	m_UniformSets.clear();
+	m_PartVisibilities.clear();
+	m_SortEntries.clear();
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include <climits>
+#include "Mesh.h"
+#include "Export.h"
+
+namespace glt
+{
+	class CModel;
+	class CShaderProgram;
+
+	//NOTE: one mesh of one model recorded for a later draw. UniformSet indexes the uniforms the command sets right before
+	//      it is drawn, UINT_MAX for none
+	struct SRenderCommand
+	{
+		unsigned long long SortKey = 0;
+		const CModel* pModel = nullptr;
+		const CShaderProgram* pShaderProgram = nullptr;
+		unsigned MeshIndex = 0;
+		unsigned UniformSet = UINT_MAX;
+		unsigned PartVisibility = UINT_MAX;
+		EVertexInput VertexInput = EVertexInput::Full;
+		bool IsPreSkinned = false;
+	};
+
+	//NOTE: the draws recorded until the next flush. The sort key holds, from the highest bits down, the pass (4 bits), the
+	//      program (12 bits), the material (16 bits), the vertex array (16 bits) and the depth (16 bits), so that sorting it
+	//      groups the commands by the state they bind. Object IDs are truncated to their bits, a clash only costs a bind
+	class GLT_DECLSPEC CRenderQueue
+	{
+	public:
+		CRenderQueue() = default;
+		~CRenderQueue() = default;
+
+		bool isEmpty() const { return m_Commands.empty(); }
+		unsigned getNumCommands() const { return static_cast<unsigned>(m_Commands.size()); }
+		const SRenderCommand& getSortedCommand(unsigned vIndex) const { _ASSERTE(vIndex < m_SortEntries.size()); return m_Commands[m_SortEntries[vIndex].Command]; }
+		const std::vector<SUniformInfo>& getUniformSet(unsigned vIndex) const { _ASSERTE(vIndex < m_UniformSets.size()); return m_UniformSets[vIndex]; }
+		const unsigned char* getPartVisibility(unsigned vOffset) const { _ASSERTE(vOffset < m_PartVisibilities.size()); return m_PartVisibilities.data() + vOffset; }
+
+		void push(const SRenderCommand& vCommand) { m_Commands.push_back(vCommand); }
+		unsigned addUniformSet(const std::vector<SUniformInfo>& vUniforms);
+		unsigned addPartVisibility(const unsigned char* vPartVisibility, unsigned vNumParts);
+		void sort();
+		void clear();
+
+		static unsigned long long computeSortKey(unsigned vPass, unsigned vProgram, unsigned vMaterial, unsigned vVertexArray, float vDepth);
+
+	private:
+		_DISALLOW_COPY_AND_ASSIGN(CRenderQueue);
+
+		struct SSortEntry
+		{
+			unsigned long long Key;
+			unsigned Command;
+		};
+
+		std::vector<SRenderCommand> m_Commands;
+		std::vector<std::vector<SUniformInfo>> m_UniformSets;
+		std::vector<unsigned char> m_PartVisibilities;
+		std::vector<SSortEntry> m_SortEntries;
+		std::vector<SSortEntry> m_SortBuffer;
+	};
+}
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/type_ptr.hpp>
+#include <limits>
+#include <algorithm>
+#include <functional>
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "VertexBuffer.h"
@@ -9,9 +12,106 @@
 #include "Model.h"
 #include "DebugUtil.h"
 #include "Skybox.h"
+#include "TextureStreamer.h"
+#include "CpuTimer.h"
+#include "ThreadPool.h"
+#include "ShaderStorageBuffer.h"
+#include "BakedAnimation.h"
+#include "UniformBuffer.h"
 
 using namespace glt;
 
+namespace
+{
+	constexpr float LOD_HYSTERESIS = 0.1f;
+
+	//NOTE: must match the BonePalette storage block of the skinning shaders
+	constexpr unsigned BONE_PALETTE_BINDING = 7;
+
+	//NOTE: must match the InstanceTransforms storage block of shaders/instance_transforms.glsl
+	constexpr unsigned INSTANCE_TRANSFORM_BINDING = 15;
+	constexpr unsigned MIN_INSTANCE_BATCH_SIZE = 2;
+
+	//NOTE: the bind pose bounds of a skinned model are grown by this fraction of their size on every side before culling,
+	//      so that an animation reaching out of the bind pose is not culled while it is still on screen
+	constexpr float SKINNED_BOUNDS_MARGIN = 0.25f;
+
+	//NOTE: the smallest storage buffer allocated for the bone palette or instance transforms of a frame, in matrices
+	constexpr size_t MIN_MATRIX_BUFFER_CAPACITY = 256;
+
+	//NOTE: must match the BakedInstances storage block of the baked animation shaders
+	constexpr unsigned BAKED_INSTANCE_BINDING = 14;
+
+	//NOTE: must match the FrameUniforms block of shaders/frame_uniforms.glsl, laid out by std140
+	constexpr unsigned FRAME_UNIFORM_BINDING = 0;
+
+	struct SFrameUniforms
+	{
+		glm::mat4 ViewMatrix;
+		glm::mat4 ProjectionMatrix;
+		glm::mat4 ViewProjectionMatrix;
+		glm::mat4 InverseViewMatrix;
+		glm::mat4 InverseProjectionMatrix;
+		glm::vec3 ViewPos;
+		float Time;
+		float NearPlane;
+		float FarPlane;
+		float Padding[2];
+	};
+	static_assert(sizeof(SFrameUniforms) == 352, "SFrameUniforms does not match the std140 layout of FrameUniforms.");
+
+	struct SInstanceBatchItem
+	{
+		const CModelAsset* pAsset = nullptr;
+		unsigned LOD = 0;
+		unsigned ModelIndex = 0;
+	};
+}
+
+//***********************************************************************************************
+//FUNCTION:
+static void __updateUniforms(const CShaderProgram& vShaderProgram, const std::vector<SUniformInfo>& vUniforms)
+{
+	for (const auto& Uniform : vUniforms)
+	{
+		switch (Uniform.Type)
+		{
+		case EUniformType::FLOAT: vShaderProgram.updateUniform1f(Uniform.Name, std::any_cast<float>(Uniform.Value)); break;
+		case EUniformType::VEC2F: vShaderProgram.updateUniform2f(Uniform.Name, std::any_cast<glm::vec2>(Uniform.Value)); break;
+		case EUniformType::VEC3F: vShaderProgram.updateUniform3f(Uniform.Name, std::any_cast<glm::vec3>(Uniform.Value)); break;
+		case EUniformType::VEC4F: vShaderProgram.updateUniform4f(Uniform.Name, std::any_cast<glm::vec4>(Uniform.Value)); break;
+		default: _OUTPUT_WARNING("The uniform type is not supported."); break;
+		}
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION: only the matrices appended since the last call are copied. The buffer grows by doubling, which re-uploads all
+//          matrices of the frame once; draws issued earlier keep the contents they were issued with
+static void __uploadAppendedMatrices(const std::vector<glm::mat4>& vMatrices, size_t& vioNumUploadedMatrices, std::shared_ptr<CShaderStorageBuffer>& vioBuffer,
+	unsigned vBindPoint)
+{
+	if (vioNumUploadedMatrices < vMatrices.size())
+	{
+		size_t RequiredSize = vMatrices.size() * sizeof(glm::mat4);
+		if (!vioBuffer || vioBuffer->getSize() < RequiredSize)
+		{
+			size_t Capacity = std::max(MIN_MATRIX_BUFFER_CAPACITY * sizeof(glm::mat4), RequiredSize);
+			if (vioBuffer) Capacity = std::max(Capacity, 2 * static_cast<size_t>(vioBuffer->getSize()));
+
+			vioBuffer = std::make_shared<CShaderStorageBuffer>(nullptr, static_cast<unsigned>(Capacity), vBindPoint);
+			vioNumUploadedMatrices = 0;
+		}
+
+		size_t NumMatrices = vMatrices.size() - vioNumUploadedMatrices;
+		vioBuffer->update(vMatrices.data() + vioNumUploadedMatrices, static_cast<unsigned>(NumMatrices * sizeof(glm::mat4)),
+			static_cast<unsigned>(vioNumUploadedMatrices * sizeof(glm::mat4)));
+		vioNumUploadedMatrices = vMatrices.size();
+	}
+
+	if (vioBuffer) vioBuffer->bindBase();
+}
+
 //***********************************************************************************************
 //FUNCTION:
 bool CRenderer::init()
@@ -29,10 +129,19 @@ bool CRenderer::init()
 	}
 #endif // DEBUG
 
+	m_RasterState = SRasterState();
+	m_IsBlendFuncKnown = true;
 	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	glDepthFunc(m_RasterState.DepthFunc);
 	glEnable(GL_CULL_FACE);
+	glCullFace(m_RasterState.CullFaceMode);
+	glDisable(GL_BLEND);
+	glBlendFunc(m_RasterState.BlendSrcFactor, m_RasterState.BlendDstFactor);
 
 	m_pCamera = new CCamera;
+	m_pFrameUniformBuffer = std::make_shared<CUniformBuffer>(static_cast<unsigned>(sizeof(SFrameUniforms)), FRAME_UNIFORM_BINDING);
+	__updateFrameUniforms();
 
 	return true;
 }
@@ -41,6 +150,8 @@ bool CRenderer::init()
 //FUNCTION:
 void CRenderer::destroy()
 {
+	CTextureStreamer::getInstance()->destroy();
+	m_pFrameUniformBuffer.reset();
 	_SAFE_DELETE(m_pCamera);
 }
 
@@ -67,34 +178,93 @@ void CRenderer::clearBuffer(GLuint vDrawBuffer, const GLfloat* vData) const
 
 //***********************************************************************************************
 //FUNCTION:
-void CRenderer::enableCullFace(bool vEnable) const
+void CRenderer::enableCullFace(bool vEnable)
 {
-	vEnable ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+	__setCapability(GL_CULL_FACE, vEnable, m_RasterState.IsCullFaceEnabled);
 }
 
 //***********************************************************************************************
 //FUNCTION:
-void CRenderer::setDepthMask(bool vFlag) const
+void CRenderer::setDepthMask(bool vFlag)
 {
+	if (m_RasterState.IsDepthWriteEnabled == vFlag) { m_FrameStatistics.NumElidedStateChanges++; return; }
+
+	m_RasterState.IsDepthWriteEnabled = vFlag;
 	glDepthMask(vFlag);
 }
 
 //***********************************************************************************************
 //FUNCTION:
-void CRenderer::enableBlend(bool vEnable) const
+void CRenderer::enableBlend(bool vEnable)
 {
-	vEnable ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+	__setCapability(GL_BLEND, vEnable, m_RasterState.IsBlendEnabled);
 }
 
 //***********************************************************************************************
-//FUNCTION:
-void CRenderer::setBlendFunc(GLenum vSrc, GLenum vDst, int vBufferIndex) const
+//FUNCTION: the blend function of a single draw buffer is set right away, the renderer does not shadow it
+void CRenderer::setBlendFunc(GLenum vSrc, GLenum vDst, int vBufferIndex)
 {
-	if (vBufferIndex == -1) glBlendFunc(vSrc, vDst);
-	else if (vBufferIndex >= 0) glBlendFunci(vBufferIndex, vSrc, vDst);
+	if (vBufferIndex == -1)
+	{
+		if (m_IsBlendFuncKnown && m_RasterState.BlendSrcFactor == vSrc && m_RasterState.BlendDstFactor == vDst) { m_FrameStatistics.NumElidedStateChanges++; return; }
+
+		m_RasterState.BlendSrcFactor = vSrc;
+		m_RasterState.BlendDstFactor = vDst;
+		m_IsBlendFuncKnown = true;
+		glBlendFunc(vSrc, vDst);
+	}
+	else if (vBufferIndex >= 0)
+	{
+		m_IsBlendFuncKnown = false;
+		glBlendFunci(vBufferIndex, vSrc, vDst);
+	}
 	else _OUTPUT_WARNING("Invalid buffer index !");
 }
 
+//***********************************************************************************************
+//FUNCTION: applies the state by diffing it against the shadow, only what differs reaches GL
+void CRenderer::setPipelineState(const CPipelineState& vPipelineState)
+{
+	const SRasterState& State = vPipelineState.getRasterState();
+
+	enableBlend(State.IsBlendEnabled);
+	if (State.IsBlendEnabled) setBlendFunc(State.BlendSrcFactor, State.BlendDstFactor);
+	__setCapability(GL_DEPTH_TEST, State.IsDepthTestEnabled, m_RasterState.IsDepthTestEnabled);
+	setDepthMask(State.IsDepthWriteEnabled);
+	if (m_RasterState.DepthFunc != State.DepthFunc)
+	{
+		m_RasterState.DepthFunc = State.DepthFunc;
+		glDepthFunc(State.DepthFunc);
+	}
+	else m_FrameStatistics.NumElidedStateChanges++;
+	enableCullFace(State.IsCullFaceEnabled);
+	if (m_RasterState.CullFaceMode != State.CullFaceMode)
+	{
+		m_RasterState.CullFaceMode = State.CullFaceMode;
+		glCullFace(State.CullFaceMode);
+	}
+	else m_FrameStatistics.NumElidedStateChanges++;
+
+	if (vPipelineState.getShaderProgram()) vPipelineState.getShaderProgram()->bind();
+}
+
+//***********************************************************************************************
+//FUNCTION:
+void CRenderer::__setCapability(GLenum vCapability, bool vEnable, bool& vioIsEnabled)
+{
+	if (vioIsEnabled == vEnable) { m_FrameStatistics.NumElidedStateChanges++; return; }
+
+	vioIsEnabled = vEnable;
+	vEnable ? glEnable(vCapability) : glDisable(vCapability);
+}
+
+//***********************************************************************************************
+//FUNCTION: every program is bound through here, CShaderProgram::bind included
+void CRenderer::_useProgram(GLuint vProgramID)
+{
+	if (m_BindState.changeProgram(vProgramID)) glUseProgram(vProgramID);
+}
+
 //***********************************************************************************************
 //FUNCTION:
 void CRenderer::memoryBarrier(GLbitfield vBarriers) const
@@ -109,8 +279,6 @@ void CRenderer::draw(const CVertexArray& vVertexArray, const CIndexBuffer& vInde
 	vVertexArray.bind();
 	vIndexBuffer.bind();
 	vShaderProgram.bind();
-
-	__updateShaderUniform(vShaderProgram);
 	glDrawElements(GL_TRIANGLES, vIndexBuffer.getCount(), GL_UNSIGNED_INT, nullptr);
 
 #ifdef _DEBUG
@@ -122,32 +290,380 @@ void CRenderer::draw(const CVertexArray& vVertexArray, const CIndexBuffer& vInde
 
 //***********************************************************************************************
 //FUNCTION:
-void CRenderer::__drawSingleModel(const CModel& vModel, const CShaderProgram& vShaderProgram)
+void CRenderer::__drawSingleModel(const CModel& vModel, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput)
 {
-	auto ModelMatrix = glm::translate(glm::mat4(1.0), vModel.getPosition());
-	ModelMatrix = glm::rotate(ModelMatrix, vModel.getRotation().w, glm::vec3(vModel.getRotation()));
-	ModelMatrix = glm::scale(ModelMatrix, vModel.getScale());
-	vShaderProgram.updateUniformMat4("uModelMatrix", ModelMatrix);
-	vShaderProgram.updateUniform1i("uHasBones", vModel._hasBones());
+	bool IsPreSkinned = __prepareModel(vModel);
+	__issueSkinningBarrier();
+
+	vShaderProgram.bind();
+	__updateModelUniform(vModel, vShaderProgram, IsPreSkinned);
+	if (!__cullMeshes(vModel))
+	{
+		vModel._draw(vShaderProgram, vVertexInput, vModel.m_CurrentLOD, IsPreSkinned, 1, &m_BindState);
+		return;
+	}
+
+	for (unsigned i = 0; i < vModel.m_pAsset->getNumMeshes(); ++i)
+		if (__isMeshVisible(i)) vModel._drawMesh(i, vShaderProgram, vVertexInput, vModel.m_CurrentLOD, IsPreSkinned, &m_BindState, __getPartVisibility(vModel, i));
+}
 
+//***********************************************************************************************
+//FUNCTION: groups the static models by asset and LOD, groups of at least MIN_INSTANCE_BATCH_SIZE models are drawn instanced
+//          and removed from vioModels. The models left keep their order
+void CRenderer::__drawInstanceBatches(std::vector<const CModel*>& vioModels, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput)
+{
+	std::vector<SInstanceBatchItem> Items;
+	for (unsigned i = 0; i < vioModels.size(); ++i)
+	{
+		const CModel* pModel = vioModels[i];
+		if (pModel->_hasBones() || !pModel->m_pAsset || !pModel->m_pAsset->isUploaded()) continue;
+
+		__updateLOD(*pModel);
+		Items.push_back({ pModel->m_pAsset.get(), pModel->m_CurrentLOD, i });
+	}
+	if (Items.size() < MIN_INSTANCE_BATCH_SIZE) return;
+
+	std::sort(Items.begin(), Items.end(), [](const SInstanceBatchItem& vLeft, const SInstanceBatchItem& vRight)
+		{
+			if (vLeft.pAsset != vRight.pAsset) return std::less<const CModelAsset*>()(vLeft.pAsset, vRight.pAsset);
+			return (vLeft.LOD != vRight.LOD) ? vLeft.LOD < vRight.LOD : vLeft.ModelIndex < vRight.ModelIndex;
+		});
+
+	std::vector<bool> IsBatched(vioModels.size(), false);
+	bool IsAnyBatched = false;
+	for (size_t Begin = 0, End = 0; Begin < Items.size(); Begin = End)
+	{
+		for (End = Begin + 1; End < Items.size() && Items[End].pAsset == Items[Begin].pAsset && Items[End].LOD == Items[Begin].LOD; ++End);
+		if (End - Begin < MIN_INSTANCE_BATCH_SIZE) continue;
+
+		unsigned InstanceOffset = static_cast<unsigned>(m_InstanceTransforms.size());
+		for (size_t i = Begin; i < End; ++i)
+		{
+			m_InstanceTransforms.push_back(vioModels[Items[i].ModelIndex]->getModelMatrix());
+			IsBatched[Items[i].ModelIndex] = true;
+		}
+
+		__drawInstanced(*vioModels[Items[Begin].ModelIndex], Items[Begin].LOD, InstanceOffset, static_cast<unsigned>(End - Begin), vShaderProgram, vVertexInput);
+		IsAnyBatched = true;
+	}
+	if (!IsAnyBatched) return;
+
+	size_t NumRemaining = 0;
+	for (size_t i = 0; i < vioModels.size(); ++i)
+		if (!IsBatched[i]) vioModels[NumRemaining++] = vioModels[i];
+	vioModels.resize(NumRemaining);
+}
+
+//***********************************************************************************************
+//FUNCTION: the model matrices of the instances have been appended to m_InstanceTransforms from vInstanceOffset on. The
+//          offset is reset afterwards, so that the program falls back to uModelMatrix for the next draws
+void CRenderer::__drawInstanced(const CModel& vModel, unsigned vLOD, unsigned vInstanceOffset, unsigned vNumInstances, const CShaderProgram& vShaderProgram,
+	EVertexInput vVertexInput)
+{
+	__uploadAppendedMatrices(m_InstanceTransforms, m_NumUploadedInstanceTransforms, m_pInstanceTransformBuffer, INSTANCE_TRANSFORM_BINDING);
+
+	vShaderProgram.bind();
+	vShaderProgram.updateUniform1i("uHasBones", false);
+	vShaderProgram.updateUniform1i("uInstanceOffset", static_cast<int>(vInstanceOffset));
+	vModel._draw(vShaderProgram, vVertexInput, vLOD, false, vNumInstances, &m_BindState);
+	vShaderProgram.updateUniform1i("uInstanceOffset", -1);
+
+	m_FrameStatistics.NumDrawnModels += vNumInstances;
+	m_FrameStatistics.NumDrawnTriangles += vNumInstances * vModel.m_pAsset->getNumTriangles(vLOD);
+	m_FrameStatistics.NumFullDetailTriangles += vNumInstances * vModel.m_pAsset->getNumTriangles(0);
+	m_FrameStatistics.NumInstancedDraws++;
+	m_FrameStatistics.NumInstancedModels += vNumInstances;
+}
+
+//***********************************************************************************************
+//FUNCTION: brings the pose of a skinned model up to date for this frame, evaluating, uploading and pre-skinning only what
+//          was not done yet, and picks the LOD of the model. Returns whether the model is drawn from its pre-skinned
+//          vertices. The pre-skinning pass may leave its own program bound, the caller issues the pending barrier before
+//          the model is drawn
+bool CRenderer::__prepareModel(const CModel& vModel)
+{
+	bool IsPreSkinned = false;
 	if (vModel._hasBones())
 	{
-		std::vector<glm::mat4> Transforms;
-		vModel._boneTransform(m_Time, Transforms);
-		glUniformMatrix4fv(glGetUniformLocation(vShaderProgram.getProgramID(), "uBonesMatrix"), Transforms.size(), GL_FALSE, glm::value_ptr(Transforms[0]));
+		__updatePose(vModel);
+
+		if (m_IsPreSkinningEnabled && vModel.m_pAsset->isUploaded())
+		{
+			if (__preSkinModel(vModel)) m_IsSkinningBarrierPending = true;
+			IsPreSkinned = true;
+		}
+	}
+
+	__updateLOD(vModel);
+
+	if (vModel.m_pAsset && vModel.m_pAsset->isUploaded())
+	{
+		m_FrameStatistics.NumDrawnModels++;
+		m_FrameStatistics.NumDrawnTriangles += vModel.m_pAsset->getNumTriangles(vModel.m_CurrentLOD);
+		m_FrameStatistics.NumFullDetailTriangles += vModel.m_pAsset->getNumTriangles(0);
+	}
+
+	return IsPreSkinned;
+}
+
+//***********************************************************************************************
+//FUNCTION: evaluates the pose of a skinned model for this frame unless that was done already and uploads it to the palette
+void CRenderer::__updatePose(const CModel& vModel)
+{
+	if (!vModel._isPoseUpToDate(m_FrameIndex, m_Time))
+	{
+		vModel.m_AnimationState.UpdateInterval = __selectAnimationUpdateInterval(vModel);
+
+		CCPUTimer Timer;
+		Timer.start();
+		bool IsEvaluated = vModel._updatePose(m_Time, m_FrameIndex, m_FrameTime);
+		Timer.stop();
+
+		(IsEvaluated ? m_FrameStatistics.NumEvaluatedPoses : m_FrameStatistics.NumInterpolatedPoses)++;
+		m_FrameStatistics.PoseEvaluationTimeInMS += Timer.getElapsedTimeInMS();
+	}
+
+	__writeBonePalette(vModel);
+	__uploadBonePalette();
+}
+
+//***********************************************************************************************
+//FUNCTION: skins every skinned model of the list that is not skinned in this frame yet, so that one barrier covers all of
+//          them before the first one is drawn
+void CRenderer::__preSkinModels(const std::vector<const CModel*>& vModels)
+{
+	if (!m_IsPreSkinningEnabled) return;
+
+	for (auto pModel : vModels)
+	{
+		if (!pModel->_hasBones() || !pModel->m_pAsset->isUploaded()) continue;
+
+		__updatePose(*pModel);
+		if (__preSkinModel(*pModel)) m_IsSkinningBarrierPending = true;
+	}
+	__issueSkinningBarrier();
+}
+
+//***********************************************************************************************
+//FUNCTION: the pre-skinned vertices are read as vertex attributes, so the draws have to wait for the skinning passes
+void CRenderer::__issueSkinningBarrier()
+{
+	if (!m_IsSkinningBarrierPending) return;
+
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+	m_IsSkinningBarrierPending = false;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+SAABB CRenderer::__computeCullingBox(const CModel& vModel) const
+{
+	SAABB Box = vModel.getAABB();
+	if (vModel._hasBones())
+	{
+		glm::vec3 Margin = (Box.Max - Box.Min) * SKINNED_BOUNDS_MARGIN;
+		Box.Min -= Margin;
+		Box.Max += Margin;
+	}
+
+	return Box;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+bool CRenderer::__isModelVisible(const CModel& vModel)
+{
+	if (!m_IsFrustumCullingEnabled || m_Frustum.isVisible(__computeCullingBox(vModel))) return true;
+
+	m_FrameStatistics.NumCulledModels++;
+	return false;
+}
+
+//***********************************************************************************************
+//FUNCTION: tests the world bounds of all models in one batch and removes the culled ones, the models left keep their order
+void CRenderer::__cullModels(std::vector<const CModel*>& vioModels)
+{
+	if (!m_IsFrustumCullingEnabled || vioModels.empty()) return;
+
+	m_CullingBoxes.clear();
+	for (auto pModel : vioModels) m_CullingBoxes.push_back(__computeCullingBox(*pModel));
+
+	unsigned NumVisible = m_Frustum.cull(m_CullingBoxes, m_CullingResults);
+	if (NumVisible == vioModels.size()) return;
+	m_FrameStatistics.NumCulledModels += static_cast<unsigned>(vioModels.size()) - NumVisible;
+
+	size_t NumRemaining = 0;
+	for (size_t i = 0; i < vioModels.size(); ++i)
+		if (m_CullingResults[i]) vioModels[NumRemaining++] = vioModels[i];
+	vioModels.resize(NumRemaining);
+}
+
+//***********************************************************************************************
+//FUNCTION: returns whether any mesh of a visible model is culled, __isMeshVisible and __getPartVisibility then tell what
+//          to draw. A merged mesh is culled part by part. The meshes of a skinned model are not culled one by one, the
+//          animated pose may have moved them out of their bounds. The triangles of the culled meshes are taken off the
+//          statistics again
+bool CRenderer::__cullMeshes(const CModel& vModel)
+{
+	const CModelAsset& Asset = *vModel.m_pAsset;
+	if (!m_IsFrustumCullingEnabled || vModel._hasBones() || !Asset.isUploaded() || Asset.getNumMeshes() == 0) return false;
+	if (Asset.getNumMeshes() == 1 && Asset.getMesh(0).getNumParts() == 0) return false;
+
+	glm::mat4 ModelMatrix = vModel.getModelMatrix();
+	m_CullingBoxes.clear();
+	m_MeshCullingOffsets.clear();
+	for (unsigned i = 0; i < Asset.getNumMeshes(); ++i)
+	{
+		const CMesh& Mesh = Asset.getMesh(i);
+		m_MeshCullingOffsets.push_back(static_cast<unsigned>(m_CullingBoxes.size()));
+		if (Mesh.getNumParts() == 0) m_CullingBoxes.push_back(Mesh.getAABB().transform(ModelMatrix));
+		for (unsigned k = 0; k < Mesh.getNumParts(); ++k) m_CullingBoxes.push_back(Mesh.getPartAABB(k).transform(ModelMatrix));
+	}
+	m_MeshCullingOffsets.push_back(static_cast<unsigned>(m_CullingBoxes.size()));
+
+	unsigned NumVisible = m_Frustum.cull(m_CullingBoxes, m_CullingResults);
+	if (NumVisible == m_CullingBoxes.size()) return false;
+
+	m_FrameStatistics.NumCulledMeshes += static_cast<unsigned>(m_CullingBoxes.size()) - NumVisible;
+	for (unsigned i = 0; i < Asset.getNumMeshes(); ++i)
+	{
+		const CMesh& Mesh = Asset.getMesh(i);
+		for (unsigned k = 0; k < m_MeshCullingOffsets[i + 1] - m_MeshCullingOffsets[i]; ++k)
+		{
+			if (m_CullingResults[m_MeshCullingOffsets[i] + k]) continue;
+			m_FrameStatistics.NumDrawnTriangles -= (Mesh.getNumParts() == 0) ? Mesh.getNumTriangles(vModel.m_CurrentLOD) : Mesh.getNumPartTriangles(k, vModel.m_CurrentLOD);
+			m_FrameStatistics.NumFullDetailTriangles -= (Mesh.getNumParts() == 0) ? Mesh.getNumTriangles(0) : Mesh.getNumPartTriangles(k, 0);
+		}
+	}
+
+	return true;
+}
+
+//***********************************************************************************************
+//FUNCTION: only valid after __cullMeshes returned true, a mesh is visible while any of its parts is
+bool CRenderer::__isMeshVisible(unsigned vMeshIndex) const
+{
+	_ASSERTE(vMeshIndex + 1 < m_MeshCullingOffsets.size());
+	for (unsigned i = m_MeshCullingOffsets[vMeshIndex]; i < m_MeshCullingOffsets[vMeshIndex + 1]; ++i)
+		if (m_CullingResults[i]) return true;
+	return false;
+}
+
+//***********************************************************************************************
+//FUNCTION: only valid after __cullMeshes returned true, null for a mesh without parts
+const unsigned char* CRenderer::__getPartVisibility(const CModel& vModel, unsigned vMeshIndex) const
+{
+	_ASSERTE(vMeshIndex + 1 < m_MeshCullingOffsets.size());
+	return (vModel.m_pAsset->getMesh(vMeshIndex).getNumParts() == 0) ? nullptr : m_CullingResults.data() + m_MeshCullingOffsets[vMeshIndex];
+}
+
+//***********************************************************************************************
+//FUNCTION: the LOD is picked once per frame, all passes of the frame draw the model at the same LOD
+void CRenderer::__updateLOD(const CModel& vModel)
+{
+	if (vModel.m_LODFrameIndex == m_FrameIndex) return;
+
+	vModel.m_CurrentLOD = m_IsLODEnabled ? __selectLOD(vModel) : 0;
+	vModel.m_LODFrameIndex = m_FrameIndex;
+}
+
+//***********************************************************************************************
+//FUNCTION: the size is the diameter of the projected bounding sphere over the screen height, a camera inside the sphere
+//          sees the model at full size or more
+float CRenderer::__computeScreenSize(const CModel& vModel) const
+{
+	SAABB Box = vModel.m_pAsset->getAABB();
+	glm::vec3 Scale = glm::abs(vModel.getScale());
+	float Radius = 0.5f * glm::length(Box.Max - Box.Min) * std::max(Scale.x, std::max(Scale.y, Scale.z));
+	glm::vec3 Center = glm::vec3(vModel.getModelMatrix() * glm::vec4(0.5f * (Box.Min + Box.Max), 1.0f));
+	float Distance = glm::length(Center - glm::vec3(m_pCamera->getPosition()));
+	if (Distance <= Radius) return std::numeric_limits<float>::max();
+
+	return Radius / (Distance * static_cast<float>(std::tan(glm::radians(m_pCamera->getFovy()) * 0.5)));
+}
+
+//***********************************************************************************************
+//FUNCTION: a band of LOD_HYSTERESIS around each boundary keeps a model sitting on it from switching back and forth
+//          every frame
+unsigned CRenderer::__selectLOD(const CModel& vModel) const
+{
+	unsigned NumLODs = vModel.getNumLODs();
+	if (NumLODs <= 1) return 0;
+
+	float ScreenSize = __computeScreenSize(vModel);
+
+	unsigned CurrentLOD = std::min(vModel.m_CurrentLOD, NumLODs - 1);
+	unsigned LOD = 0;
+	for (unsigned i = 0; i < NumLODs - 1 && i < m_LODScreenSizes.size(); ++i)
+	{
+		float Threshold = m_LODScreenSizes[i] * ((CurrentLOD <= i) ? 1.0f - LOD_HYSTERESIS : 1.0f + LOD_HYSTERESIS);
+		if (ScreenSize < Threshold) LOD = i + 1;
+	}
+
+	return LOD;
+}
+
+//***********************************************************************************************
+//FUNCTION: uses the same hysteresis band as the mesh LOD
+unsigned CRenderer::__selectAnimationUpdateInterval(const CModel& vModel) const
+{
+	if (!m_IsAnimationLODEnabled || m_AnimationLODScreenSizes.empty()) return 1;
+
+	float ScreenSize = __computeScreenSize(vModel);
+
+	unsigned CurrentLevel = 0;
+	while ((2u << CurrentLevel) <= vModel.m_AnimationState.UpdateInterval) ++CurrentLevel;
+
+	unsigned Level = 0;
+	for (unsigned i = 0; i < m_AnimationLODScreenSizes.size(); ++i)
+	{
+		float Threshold = m_AnimationLODScreenSizes[i] * ((CurrentLevel <= i) ? 1.0f - LOD_HYSTERESIS : 1.0f + LOD_HYSTERESIS);
+		if (ScreenSize < Threshold) Level = i + 1;
 	}
 
-	vModel._draw(vShaderProgram);
+	return 1u << Level;
 }
 
 //***********************************************************************************************
 //FUNCTION:
-void CRenderer::draw(const CModel& vModel, const CShaderProgram& vShaderProgram)
+void CRenderer::draw(const CModel& vModel, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput)
 {
+	if (!__isModelVisible(vModel)) return;
+
+	m_BindState.reset();
 	vShaderProgram.bind();
+	__drawSingleModel(vModel, vShaderProgram, vVertexInput);
+
+#ifdef _DEBUG
+	vShaderProgram.unbind();
+#endif
+}
+
+//***********************************************************************************************
+//FUNCTION: the models outside of the view frustum are dropped first, the meshes and merged mesh parts of the others are
+//          culled as they are drawn. Static models sharing their asset and LOD are drawn together by one instanced draw
+//          if the program reads its model matrix through fetchModelMatrix. The other models are drawn mesh by mesh sorted
+//          by state with the command queue enabled and one after another otherwise
+void CRenderer::draw(const std::vector<std::shared_ptr<CModel>>& vModels, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput)
+{
+	std::vector<const CModel*> Models;
+	Models.reserve(vModels.size());
+	for (const auto& pModel : vModels) Models.push_back(pModel.get());
+	__cullModels(Models);
 
-	__updateShaderUniform(vShaderProgram);
-	__drawSingleModel(vModel, vShaderProgram);
+	m_BindState.reset();
+	if (m_IsInstanceBatchingEnabled && vShaderProgram.hasUniform("uInstanceOffset")) __drawInstanceBatches(Models, vShaderProgram, vVertexInput);
+
+	if (m_IsCommandQueueEnabled)
+	{
+		for (auto pModel : Models) submit(*pModel, vShaderProgram, vVertexInput);
+		flush();
+		return;
+	}
+
+	__preSkinModels(Models);
+	vShaderProgram.bind();
+	for (auto pModel : Models) __drawSingleModel(*pModel, vShaderProgram, vVertexInput);
 
 #ifdef _DEBUG
 	vShaderProgram.unbind();
@@ -155,29 +671,258 @@ void CRenderer::draw(const CModel& vModel, const CShaderProgram& vShaderProgram)
 }
 
 //***********************************************************************************************
-//FUNCTION:
-void CRenderer::draw(const std::vector<std::shared_ptr<CModel>>& vModels, const CShaderProgram& vShaderProgram)
+//FUNCTION: draws the model once per transform with one instanced draw per mesh range, leaving out the instances outside of
+//          the view frustum. The instances are drawn at LOD 0 and a skinned model in its bind pose, the program reads the
+//          model matrix of an instance through fetchModelMatrix
+void CRenderer::drawInstances(const CModel& vModel, const std::vector<glm::mat4>& vTransforms, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput)
 {
+	if (vTransforms.empty() || !vModel.getAsset() || !vModel.getAsset()->isUploaded()) return;
+	_ASSERTE(vShaderProgram.hasUniform("uInstanceOffset"));
+
+	unsigned InstanceOffset = static_cast<unsigned>(m_InstanceTransforms.size());
+	if (m_IsFrustumCullingEnabled)
+	{
+		SAABB Box = vModel.m_pAsset->getAABB();
+		m_CullingBoxes.clear();
+		for (const auto& Transform : vTransforms) m_CullingBoxes.push_back(Box.transform(Transform));
+
+		unsigned NumVisible = m_Frustum.cull(m_CullingBoxes, m_CullingResults);
+		m_FrameStatistics.NumCulledModels += static_cast<unsigned>(vTransforms.size()) - NumVisible;
+		for (size_t i = 0; i < vTransforms.size(); ++i)
+			if (m_CullingResults[i]) m_InstanceTransforms.push_back(vTransforms[i]);
+	}
+	else m_InstanceTransforms.insert(m_InstanceTransforms.end(), vTransforms.begin(), vTransforms.end());
+
+	unsigned NumInstances = static_cast<unsigned>(m_InstanceTransforms.size()) - InstanceOffset;
+	if (NumInstances == 0) return;
+
+	m_BindState.reset();
+	__drawInstanced(vModel, 0, InstanceOffset, NumInstances, vShaderProgram, vVertexInput);
+
+#ifdef _DEBUG
+	vShaderProgram.unbind();
+#endif
+}
+
+//***********************************************************************************************
+//FUNCTION: draws all instances with one instanced draw per mesh range, none of them is evaluated or skinned on the CPU.
+//          The instances go into a storage buffer that only grows, the shader looks up their poses in the baked animation
+void CRenderer::drawInstances(const CModel& vModel, const CBakedAnimation& vAnimation, const std::vector<SBakedInstance>& vInstances, const CShaderProgram& vShaderProgram,
+	EVertexInput vVertexInput)
+{
+	if (vInstances.empty() || !vModel.getAsset() || !vModel.getAsset()->isUploaded()) return;
+
+	size_t RequiredSize = vInstances.size() * sizeof(SBakedInstance);
+	if (!m_pBakedInstanceBuffer || m_pBakedInstanceBuffer->getSize() < RequiredSize)
+	{
+		size_t Capacity = m_pBakedInstanceBuffer ? std::max(RequiredSize, 2 * static_cast<size_t>(m_pBakedInstanceBuffer->getSize())) : RequiredSize;
+		m_pBakedInstanceBuffer = std::make_shared<CShaderStorageBuffer>(nullptr, static_cast<unsigned>(Capacity), BAKED_INSTANCE_BINDING);
+	}
+	m_pBakedInstanceBuffer->update(vInstances.data(), static_cast<unsigned>(RequiredSize));
+	m_pBakedInstanceBuffer->bindBase();
+	vAnimation._bind();
+
+	m_BindState.reset();
 	vShaderProgram.bind();
+	vShaderProgram.updateUniform1i("uNumBakedBones", static_cast<int>(vAnimation.getNumBones()));
+
+	vModel._draw(vShaderProgram, vVertexInput, 0, false, static_cast<unsigned>(vInstances.size()), &m_BindState);
 
-	__updateShaderUniform(vShaderProgram);
-	for (const auto& Model : vModels) __drawSingleModel(*Model, vShaderProgram);
+	unsigned NumInstances = static_cast<unsigned>(vInstances.size());
+	m_FrameStatistics.NumDrawnModels += NumInstances;
+	m_FrameStatistics.NumDrawnTriangles += NumInstances * vModel.getAsset()->getNumTriangles(0);
+	m_FrameStatistics.NumFullDetailTriangles += NumInstances * vModel.getAsset()->getNumTriangles(0);
 
 #ifdef _DEBUG
 	vShaderProgram.unbind();
 #endif
 }
 
+//***********************************************************************************************
+//FUNCTION: records every mesh of the model for the next flush. The pose and LOD of the model are brought up to date right
+//          away, so that nothing but the draws is left for the flush. vUniforms are set before the meshes are drawn, they
+//          take the place of uniforms a caller would set between immediate draws
+void CRenderer::submit(const CModel& vModel, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput, unsigned vPass, const std::vector<SUniformInfo>& vUniforms)
+{
+	if (!vModel.m_pAsset || !vModel.m_pAsset->isUploaded() || !__isModelVisible(vModel)) return;
+	m_BindState.reset();
+
+	SRenderCommand Command;
+	Command.pModel = &vModel;
+	Command.pShaderProgram = &vShaderProgram;
+	Command.VertexInput = vVertexInput;
+	Command.IsPreSkinned = __prepareModel(vModel);
+	if (!vUniforms.empty()) Command.UniformSet = m_RenderQueue.addUniformSet(vUniforms);
+
+	SAABB Box = vModel.getAABB();
+	float Depth = glm::length(0.5f * (Box.Min + Box.Max) - glm::vec3(m_pCamera->getPosition())) / static_cast<float>(m_pCamera->getFar());
+
+	bool IsAnyMeshCulled = __cullMeshes(vModel);
+	const CModelAsset& Asset = *vModel.m_pAsset;
+	for (unsigned i = 0; i < Asset.getNumMeshes(); ++i)
+	{
+		if (IsAnyMeshCulled && !__isMeshVisible(i)) continue;
+
+		const auto& SkinnedMeshes = vModel.m_AnimationState.SkinnedMeshes;
+		const SSkinnedVertices* pSkinnedVertices = (Command.IsPreSkinned && i < SkinnedMeshes.size()) ? &SkinnedMeshes[i] : nullptr;
+		const CMesh& Mesh = Asset.getMesh(i);
+		GLuint Material = (vVertexInput == EVertexInput::PositionOnly) ? 0 : Mesh.getMaterialKey();
+
+		const unsigned char* pPartVisibility = IsAnyMeshCulled ? __getPartVisibility(vModel, i) : nullptr;
+		Command.PartVisibility = pPartVisibility ? m_RenderQueue.addPartVisibility(pPartVisibility, Mesh.getNumParts()) : UINT_MAX;
+		Command.MeshIndex = i;
+		Command.SortKey = CRenderQueue::computeSortKey(vPass, vShaderProgram.getProgramID(), Material, Mesh.getVertexArrayID(vVertexInput, pSkinnedVertices), Depth);
+		m_RenderQueue.push(Command);
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION: draws the commands submitted since the last flush sorted by their keys. The camera uniforms are set once per
+//          program and the model uniforms once per model, a program, vertex array or texture bound by an earlier command
+//          is not bound again
+void CRenderer::flush()
+{
+	if (m_RenderQueue.isEmpty()) return;
+
+	m_RenderQueue.sort();
+	m_BindState.reset();
+	__issueSkinningBarrier();
+
+	const CShaderProgram* pShaderProgram = nullptr;
+	const CModel* pModel = nullptr;
+	for (unsigned i = 0; i < m_RenderQueue.getNumCommands(); ++i)
+	{
+		const SRenderCommand& Command = m_RenderQueue.getSortedCommand(i);
+		if (Command.pShaderProgram != pShaderProgram)
+		{
+			pShaderProgram = Command.pShaderProgram;
+			pModel = nullptr;
+			pShaderProgram->bind();
+		}
+
+		if (Command.pModel != pModel)
+		{
+			pModel = Command.pModel;
+			__updateModelUniform(*pModel, *pShaderProgram, Command.IsPreSkinned);
+		}
+
+		if (Command.UniformSet != UINT_MAX) __updateUniforms(*pShaderProgram, m_RenderQueue.getUniformSet(Command.UniformSet));
+
+		const unsigned char* pPartVisibility = (Command.PartVisibility != UINT_MAX) ? m_RenderQueue.getPartVisibility(Command.PartVisibility) : nullptr;
+		pModel->_drawMesh(Command.MeshIndex, *pShaderProgram, Command.VertexInput, pModel->m_CurrentLOD, Command.IsPreSkinned, &m_BindState, pPartVisibility);
+	}
+
+	m_RenderQueue.clear();
+
+#ifdef _DEBUG
+	glBindVertexArray(0);
+	_useProgram(0);
+	m_BindState.reset();
+#endif
+}
+
+//***********************************************************************************************
+//FUNCTION: evaluates this frame's pose of every skinned model on the thread pool, the calling thread takes a share of the
+//          work as well. Models updated here are neither evaluated nor uploaded again when they are drawn in this frame
+void CRenderer::updatePoses(const std::vector<std::shared_ptr<CModel>>& vModels)
+{
+	std::vector<const CModel*> Models;
+	for (const auto& pModel : vModels)
+		if (pModel->_hasBones() && pModel->getAsset()->isUploaded() && !pModel->_isPoseUpToDate(m_FrameIndex, m_Time)
+			&& (!m_IsFrustumCullingEnabled || m_Frustum.isVisible(__computeCullingBox(*pModel)))) Models.push_back(pModel.get());
+	if (Models.empty()) return;
+
+	for (auto pModel : Models) pModel->m_AnimationState.UpdateInterval = __selectAnimationUpdateInterval(*pModel);
+
+	CCPUTimer Timer;
+	Timer.start();
+
+	size_t NumTasks = std::min(Models.size(), CThreadPool::getInstance()->getNumThreads() + 1);
+	size_t NumModelsPerTask = (Models.size() + NumTasks - 1) / NumTasks;
+	std::vector<unsigned> NumEvaluatedPoses(NumTasks, 0);
+	auto UpdateRange = [&Models, &NumEvaluatedPoses, NumModelsPerTask, this](size_t vTask)
+	{
+		size_t End = std::min(Models.size(), (vTask + 1) * NumModelsPerTask);
+		for (size_t i = vTask * NumModelsPerTask; i < End; ++i)
+			if (Models[i]->_updatePose(m_Time, m_FrameIndex, m_FrameTime)) NumEvaluatedPoses[vTask]++;
+	};
+
+	std::vector<std::future<void>> Results;
+	for (size_t i = 1; i < NumTasks; ++i) Results.push_back(CThreadPool::getInstance()->submit([&UpdateRange, i]() { UpdateRange(i); }));
+	UpdateRange(0);
+	for (auto& Result : Results) Result.wait();
+
+	for (auto pModel : Models) __writeBonePalette(*pModel);
+	__uploadBonePalette();
+
+	if (m_IsPreSkinningEnabled)
+	{
+		m_BindState.reset();
+		for (auto pModel : Models)
+			if (__preSkinModel(*pModel)) m_IsSkinningBarrierPending = true;
+		__issueSkinningBarrier();
+	}
+
+	Timer.stop();
+	unsigned NumEvaluated = 0;
+	for (auto Count : NumEvaluatedPoses) NumEvaluated += Count;
+	m_FrameStatistics.NumEvaluatedPoses += NumEvaluated;
+	m_FrameStatistics.NumInterpolatedPoses += static_cast<unsigned>(Models.size()) - NumEvaluated;
+	m_FrameStatistics.PoseEvaluationTimeInMS += Timer.getElapsedTimeInMS();
+}
+
+//***********************************************************************************************
+//FUNCTION: appends the pose of the model to this frame's palette unless it is already there, returns its first matrix
+unsigned CRenderer::__writeBonePalette(const CModel& vModel)
+{
+	auto& State = vModel.m_AnimationState;
+	if (State.IsPoseUploaded) return State.PaletteOffset;
+
+	State.PaletteOffset = static_cast<unsigned>(m_BonePalette.size());
+	State.IsPoseUploaded = true;
+	m_BonePalette.insert(m_BonePalette.end(), State.BoneTransforms.begin(), State.BoneTransforms.end());
+	m_FrameStatistics.NumUploadedPoses++;
+
+	return State.PaletteOffset;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+void CRenderer::__uploadBonePalette()
+{
+	__uploadAppendedMatrices(m_BonePalette, m_NumUploadedBoneMatrices, m_pBonePaletteBuffer, BONE_PALETTE_BINDING);
+}
+
+//***********************************************************************************************
+//FUNCTION: skins the uploaded pose of the model unless that was done in this frame already. Binds the skinning program
+//          and returns whether anything was dispatched, the caller issues the barrier
+bool CRenderer::__preSkinModel(const CModel& vModel)
+{
+	if (vModel.m_AnimationState.IsPoseSkinned) return false;
+
+	if (!m_pPreSkinningProgram)
+	{
+		m_pPreSkinningProgram = std::make_shared<CShaderProgram>();
+		m_pPreSkinningProgram->addShader("shaders/pre_skinning_cs.glsl", EShaderType::COMPUTE_SHADER);
+	}
+
+	m_pPreSkinningProgram->bind();
+	m_pPreSkinningProgram->updateUniform1i("uBoneOffset", static_cast<int>(vModel.m_AnimationState.PaletteOffset));
+	m_FrameStatistics.NumPreSkinnedVertices += vModel._skin(*m_pPreSkinningProgram);
+
+	return true;
+}
+
 //***********************************************************************************************
 //FUNCTION:
 void CRenderer::drawScreenQuad(const CShaderProgram& vShaderProgram)
 {
 	if (!m_FullScreenQuadVAO) __initFullScreenQuad();
 
+	m_BindState.reset();
 	vShaderProgram.bind();
-	vShaderProgram.updateUniform3f("uViewPos", m_pCamera->getPosition());
 
-	m_FullScreenQuadVAO->bind();
+	if (m_BindState.changeVertexArray(m_FullScreenQuadVAO->getObjectID())) m_FullScreenQuadVAO->bind();
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
 #ifdef _DEBUG
@@ -193,8 +938,6 @@ void CRenderer::drawSkybox(const CSkybox& vSkybox, unsigned int vBindPoint)
 	auto pShaderProgram = vSkybox._getShaderProgram();
 	_ASSERT(pShaderProgram);
 	pShaderProgram->bind();
-	pShaderProgram->updateUniformMat4("uProjectionMatrix", m_pCamera->getProjectionMatrix());
-	pShaderProgram->updateUniformMat4("uViewMatrix", m_pCamera->getViewMatrix());
 	vSkybox._draw(vBindPoint);
 }
 
@@ -203,15 +946,56 @@ void CRenderer::drawSkybox(const CSkybox& vSkybox, unsigned int vBindPoint)
 void CRenderer::update()
 {
 	m_pCamera->update();
+	__updateFrameUniforms();
+	CTextureStreamer::getInstance()->update();
+
+	m_FrameStatistics.NumProgramBinds = m_BindState.NumProgramBinds;
+	m_FrameStatistics.NumVertexArrayBinds = m_BindState.NumVertexArrayBinds;
+	m_FrameStatistics.NumTextureBinds = m_BindState.NumTextureBinds;
+	m_FrameStatistics.NumElidedStateChanges += m_BindState.NumElidedBinds;
+	m_BindState.NumProgramBinds = m_BindState.NumVertexArrayBinds = m_BindState.NumTextureBinds = m_BindState.NumElidedBinds = 0;
+
+	m_LastFrameStatistics = m_FrameStatistics;
+	m_FrameStatistics = SRenderStatistics();
+	m_FrameIndex++;
+
+	m_BonePalette.clear();
+	m_NumUploadedBoneMatrices = 0;
+	m_InstanceTransforms.clear();
+	m_NumUploadedInstanceTransforms = 0;
 }
 
 //***********************************************************************************************
-//FUNCTION:
-void CRenderer::__updateShaderUniform(const CShaderProgram& vShaderProgram) const
+//FUNCTION: the camera data of the whole frame in one upload, every program reads it from the same binding. The frustum
+//          the frame is culled against is taken from the same camera
+void CRenderer::__updateFrameUniforms()
+{
+	SFrameUniforms FrameUniforms;
+	FrameUniforms.ViewMatrix = m_pCamera->getViewMatrix();
+	FrameUniforms.ProjectionMatrix = m_pCamera->getProjectionMatrix();
+	FrameUniforms.ViewProjectionMatrix = FrameUniforms.ProjectionMatrix * FrameUniforms.ViewMatrix;
+	FrameUniforms.InverseViewMatrix = glm::inverse(FrameUniforms.ViewMatrix);
+	FrameUniforms.InverseProjectionMatrix = glm::inverse(FrameUniforms.ProjectionMatrix);
+	FrameUniforms.ViewPos = m_pCamera->getPosition();
+	FrameUniforms.Time = m_Time;
+	FrameUniforms.NearPlane = static_cast<float>(m_pCamera->getNear());
+	FrameUniforms.FarPlane = static_cast<float>(m_pCamera->getFar());
+
+	m_pFrameUniformBuffer->update(&FrameUniforms, static_cast<unsigned>(sizeof(SFrameUniforms)));
+	m_pFrameUniformBuffer->bindBase();
+
+	m_Frustum = CFrustum(FrameUniforms.ViewProjectionMatrix);
+}
+
+//***********************************************************************************************
+//FUNCTION: a pre-skinned model is drawn like a static one
+void CRenderer::__updateModelUniform(const CModel& vModel, const CShaderProgram& vShaderProgram, bool vIsPreSkinned) const
 {
-	vShaderProgram.updateUniform3f("uViewPos", m_pCamera->getPosition());
-	vShaderProgram.updateUniformMat4("uProjectionMatrix", m_pCamera->getProjectionMatrix());
-	vShaderProgram.updateUniformMat4("uViewMatrix", m_pCamera->getViewMatrix());
+	bool IsSkinnedByShader = vModel._hasBones() && !vIsPreSkinned;
+
+	vShaderProgram.updateUniformMat4("uModelMatrix", vModel.getModelMatrix());
+	if (IsSkinnedByShader) vShaderProgram.updateUniform1i("uBoneOffset", static_cast<int>(vModel.m_AnimationState.PaletteOffset));
+	vShaderProgram.updateUniform1i("uHasBones", IsSkinnedByShader);
 }
 
 //***********************************************************************************************
@@ -4,6 +4,10 @@
 #include <glad/glad.h>
 #include "Common.h"
 #include "Camera.h"
+#include "Mesh.h"
+#include "RenderQueue.h"
+#include "PipelineState.h"
+#include "Frustum.h"
 #include "Export.h"
 
 namespace glt
@@ -14,6 +18,30 @@ namespace glt
 	class CShaderProgram;
 	class CModel;
 	class CSkybox;
+	class CShaderStorageBuffer;
+	class CUniformBuffer;
+	class CBakedAnimation;
+	struct SBakedInstance;
+
+	struct SRenderStatistics
+	{
+		unsigned NumDrawnModels = 0;
+		unsigned NumDrawnTriangles = 0;
+		unsigned NumFullDetailTriangles = 0;
+		unsigned NumEvaluatedPoses = 0;
+		unsigned NumInterpolatedPoses = 0;
+		unsigned NumUploadedPoses = 0;
+		unsigned NumPreSkinnedVertices = 0;
+		unsigned NumProgramBinds = 0;
+		unsigned NumVertexArrayBinds = 0;
+		unsigned NumTextureBinds = 0;
+		unsigned NumElidedStateChanges = 0;
+		unsigned NumInstancedDraws = 0;
+		unsigned NumInstancedModels = 0;
+		unsigned NumCulledModels = 0;
+		unsigned NumCulledMeshes = 0;
+		double PoseEvaluationTimeInMS = 0.0;
+	};
 
 	class GLT_DECLSPEC CRenderer
 	{
@@ -29,39 +57,149 @@ namespace glt
 		void clearBuffer(GLuint vDrawBuffer, const GLfloat* vData) const;
 		void update();
 
-		void enableCullFace(bool vEnable) const;
-		void setDepthMask(bool vFlag) const;
+		void enableCullFace(bool vEnable);
+		void setDepthMask(bool vFlag);
+
+		void enableBlend(bool vEnable);  //TODO: ķװ
+		void setBlendFunc(GLenum vSrc, GLenum vDst, int vBufferIndex = -1); //
 
-		void enableBlend(bool vEnable) const;  //TODO: ķװ
-		void setBlendFunc(GLenum vSrc, GLenum vDst, int vBufferIndex = -1) const; //
+		void setPipelineState(const CPipelineState& vPipelineState);
+		const SRasterState& getRasterState() const { return m_RasterState; }
 
 		void memoryBarrier(GLbitfield vBarriers) const;
 
+		void enableLOD(bool vEnable) { m_IsLODEnabled = vEnable; }
+		void setLODScreenSizes(const std::vector<float>& vScreenSizes) { m_LODScreenSizes = vScreenSizes; }
+		void enablePreSkinning(bool vEnable) { m_IsPreSkinningEnabled = vEnable; }
+		void enableAnimationLOD(bool vEnable) { m_IsAnimationLODEnabled = vEnable; }
+		void setAnimationLODScreenSizes(const std::vector<float>& vScreenSizes) { m_AnimationLODScreenSizes = vScreenSizes; }
+		void enableCommandQueue(bool vEnable) { m_IsCommandQueueEnabled = vEnable; }
+		void enableInstanceBatching(bool vEnable) { m_IsInstanceBatchingEnabled = vEnable; }
+		void enableFrustumCulling(bool vEnable) { m_IsFrustumCullingEnabled = vEnable; }
+
 		void draw(const CVertexArray& vVertexArray, const CIndexBuffer& vIndexBuffer, const CShaderProgram& vShaderProgram) const;
-		void draw(const CModel& vModel, const CShaderProgram& vShaderProgram);
-		void draw(const std::vector<std::shared_ptr<CModel>>& vModels, const CShaderProgram& vShaderProgram);
+		void draw(const CModel& vModel, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput = EVertexInput::Full);
+		void draw(const std::vector<std::shared_ptr<CModel>>& vModels, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput = EVertexInput::Full);
+		void drawInstances(const CModel& vModel, const std::vector<glm::mat4>& vTransforms, const CShaderProgram& vShaderProgram,
+			EVertexInput vVertexInput = EVertexInput::Full);
+		void drawInstances(const CModel& vModel, const CBakedAnimation& vAnimation, const std::vector<SBakedInstance>& vInstances, const CShaderProgram& vShaderProgram,
+			EVertexInput vVertexInput = EVertexInput::Full);
 		void drawScreenQuad(const CShaderProgram& vShaderProgram);
+		void submit(const CModel& vModel, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput = EVertexInput::Full, unsigned vPass = 0,
+			const std::vector<SUniformInfo>& vUniforms = {});
+		void flush();
+		void updatePoses(const std::vector<std::shared_ptr<CModel>>& vModels);
 		void drawSkybox(const CSkybox& vSkybox, unsigned int vBindPoint);
 
 		CCamera* fetchCamera() const { return m_pCamera; }
+		const CFrustum& getFrustum() const { return m_Frustum; }
+		const SRenderStatistics& getStatistics() const { return m_LastFrameStatistics; }
 
 	protected:
-		void _setTime(float vTime) { m_Time = vTime; }
+		void _setTime(float vTime) { m_FrameTime = (vTime > m_Time) ? vTime - m_Time : 0.0f; m_Time = vTime; }
+		void _useProgram(GLuint vProgramID);
 
 	private:
 		CRenderer() = default;
 		_DISALLOW_COPY_AND_ASSIGN(CRenderer);
 
-		void __drawSingleModel(const CModel& vModel, const CShaderProgram& vShaderProgram);
-		void __updateShaderUniform(const CShaderProgram& vShaderProgram) const;
+		void __drawSingleModel(const CModel& vModel, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput);
+		void __drawInstanceBatches(std::vector<const CModel*>& vioModels, const CShaderProgram& vShaderProgram, EVertexInput vVertexInput);
+		void __drawInstanced(const CModel& vModel, unsigned vLOD, unsigned vInstanceOffset, unsigned vNumInstances, const CShaderProgram& vShaderProgram,
+			EVertexInput vVertexInput);
+		bool __prepareModel(const CModel& vModel);
+		void __updatePose(const CModel& vModel);
+		void __preSkinModels(const std::vector<const CModel*>& vModels);
+		void __issueSkinningBarrier();
+		void __updateLOD(const CModel& vModel);
+		SAABB __computeCullingBox(const CModel& vModel) const;
+		bool __isModelVisible(const CModel& vModel);
+		void __cullModels(std::vector<const CModel*>& vioModels);
+		bool __cullMeshes(const CModel& vModel);
+		bool __isMeshVisible(unsigned vMeshIndex) const;
+		const unsigned char* __getPartVisibility(const CModel& vModel, unsigned vMeshIndex) const;
+		void __setCapability(GLenum vCapability, bool vEnable, bool& vioIsEnabled);
+		void __updateFrameUniforms();
+		void __updateModelUniform(const CModel& vModel, const CShaderProgram& vShaderProgram, bool vIsPreSkinned) const;
+		float __computeScreenSize(const CModel& vModel) const;
+		unsigned __selectLOD(const CModel& vModel) const;
+		unsigned __selectAnimationUpdateInterval(const CModel& vModel) const;
+		unsigned __writeBonePalette(const CModel& vModel);
+		void __uploadBonePalette();
+		bool __preSkinModel(const CModel& vModel);
 		void __initFullScreenQuad();
 
 		CCamera* m_pCamera = nullptr;
 		float m_Time = 0.0f;
+		float m_FrameTime = 0.0f;
+		unsigned m_FrameIndex = 0;
+
+		//NOTE: the camera and time of the frame, written once by update. A camera changed later in the frame is seen by
+		//      the shaders from the next frame on
+		std::shared_ptr<CUniformBuffer> m_pFrameUniformBuffer;
+
+		//NOTE: once enableFrustumCulling is called, models and meshes outside of the frustum of the frame are neither drawn
+		//      nor animated, the parts of a merged mesh are culled one by one. m_MeshCullingOffsets[i] is the first culling
+		//      result of mesh i. The baked instances of drawInstances are not culled, their animated bounds are not known on
+		//      the CPU
+		bool m_IsFrustumCullingEnabled = false;
+		CFrustum m_Frustum;
+		std::vector<SAABB> m_CullingBoxes;
+		std::vector<unsigned char> m_CullingResults;
+		std::vector<unsigned> m_MeshCullingOffsets;
+
+		//NOTE: LOD i is left for LOD i+1 once the projected bounding sphere drops below m_LODScreenSizes[i] of the screen height.
+		//      Off by default, every model is drawn at LOD 0 unless enableLOD is called
+		bool m_IsLODEnabled = false;
+		std::vector<float> m_LODScreenSizes = { 0.5f, 0.25f, 0.125f };
+
+		//NOTE: the pose of a skinned model is evaluated every 2^(i+1)-th frame once its projected size drops below
+		//      m_AnimationLODScreenSizes[i], the frames in between are blended from the poses evaluated last. Off by default,
+		//      enableAnimationLOD turns it on
+		bool m_IsAnimationLODEnabled = false;
+		std::vector<float> m_AnimationLODScreenSizes = { 0.2f, 0.1f };
+
+		//NOTE: the poses of all skinned models drawn in this frame, every model addresses its own slice by offset
+		std::vector<glm::mat4> m_BonePalette;
+		size_t m_NumUploadedBoneMatrices = 0;
+		std::shared_ptr<CShaderStorageBuffer> m_pBonePaletteBuffer;
+
+		//NOTE: with pre-skinning every skinned model is skinned by a compute pass once per frame and then drawn like a
+		//      static model by all passes of that frame. A skinning pass only flags the vertex attribute barrier, which is
+		//      issued once before the next draw, so a list of models skinned together costs one barrier
+		bool m_IsPreSkinningEnabled = false;
+		bool m_IsSkinningBarrierPending = false;
+		std::shared_ptr<CShaderProgram> m_pPreSkinningProgram;
+
+		std::shared_ptr<CShaderStorageBuffer> m_pBakedInstanceBuffer;
+
+		//NOTE: the model matrices of all instanced draws of this frame, every draw addresses its own slice by offset. A list
+		//      of models is batched into instanced draws once enableInstanceBatching is called, unless the program cannot read
+		//      the slice
+		bool m_IsInstanceBatchingEnabled = false;
+		std::vector<glm::mat4> m_InstanceTransforms;
+		size_t m_NumUploadedInstanceTransforms = 0;
+		std::shared_ptr<CShaderStorageBuffer> m_pInstanceTransformBuffer;
+
+		//NOTE: with the command queue enabled a list of models is recorded and drawn sorted by state, as submit and flush do.
+		//      Every public draw forgets the vertex arrays and textures of the bind state, they may have been bound outside
+		//      of the renderer
+		bool m_IsCommandQueueEnabled = false;
+		CRenderQueue m_RenderQueue;
+		SBindState m_BindState;
+
+		//NOTE: the fixed function state as last set through the renderer, state changes that would not change it are
+		//      skipped. The blend function is unknown once it has been set per draw buffer
+		SRasterState m_RasterState;
+		bool m_IsBlendFuncKnown = true;
+
+		SRenderStatistics m_FrameStatistics;
+		SRenderStatistics m_LastFrameStatistics;
 
 		std::shared_ptr<CVertexArray>	m_FullScreenQuadVAO;
 		std::shared_ptr<CVertexBuffer>	m_FullScreenQuadVBO;
 
 		friend class CApplicationBase;
+		friend class CShaderProgram;
 	};
 }
\ No newline at end of file
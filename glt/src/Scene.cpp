@@ -1,16 +1,64 @@
 #include "Scene.h"
 #include "Model.h"
 #include "JsonUtil.h"
+#include "ThreadPool.h"
+#include "FileLocator.h"
 
 using namespace glt;
 
 //************************************************************
-//FUNCTION:
-void CScene::load(const std::string& vFilePath)
+//FUNCTION: the worker threads capture this scene, so outstanding imports are waited for before it goes away
+CScene::~CScene()
+{
+	std::unique_lock<std::mutex> Lock(m_UploadQueueMutex);
+	m_UploadQueueCondition.wait(Lock, [this]() { return m_UploadQueue.size() == m_NumPendingImports; });
+}
+
+//************************************************************
+//FUNCTION: the models are imported on the worker threads while the calling thread keeps uploading the finished ones
+void CScene::load(const std::string& vFilePath, const SModelLoadOptions& vOptions)
 {
+	std::future<void> Loaded = loadAsync(vFilePath, nullptr, vOptions);
+	while (isLoading())
+	{
+		{
+			std::unique_lock<std::mutex> Lock(m_UploadQueueMutex);
+			m_UploadQueueCondition.wait(Lock, [this]() { return !m_UploadQueue.empty(); });
+		}
+		update();
+	}
+	Loaded.get();
+}
+
+//************************************************************
+//FUNCTION: returns immediately, update() has to be called on the GL thread (e.g. once per frame) until the returned
+//          future is ready. The callback is invoked on the GL thread after the last model has been uploaded
+std::future<void> CScene::loadAsync(const std::string& vFilePath, std::function<void()> vOnLoadedCallback, const SModelLoadOptions& vOptions)
+{
+	_ASSERTE(!isLoading());
+
+	m_LoadOptions = vOptions;
+	m_LoadedPromise = std::promise<void>();
+	m_OnLoadedCallback = vOnLoadedCallback;
+	std::future<void> Loaded = m_LoadedPromise.get_future();
+
 	CJsonReader JsonReader(vFilePath);
 	const auto& Doc = JsonReader.getDocument();
 	if (Doc.HasMember("models")) __parseModels(Doc["models"]);
+
+	if (!isLoading()) __finishLoading();
+
+	return Loaded;
+}
+
+//************************************************************
+//FUNCTION: must be called on the thread owning the GL context
+void CScene::update()
+{
+	if (!isLoading()) return;
+
+	__uploadImportedModels();
+	if (!isLoading()) __finishLoading();
 }
 
 //************************************************************
@@ -28,25 +76,28 @@ void CScene::__parseModels(const rapidjson::Value& vValue)
 	for (auto iter = vValue.MemberBegin(); iter != vValue.MemberEnd(); ++iter)
 	{
 		std::string GroupName = iter->name.GetString();
+		_ASSERTE(m_ModelGroupMap.find(GroupName) == m_ModelGroupMap.end());
+		m_ModelGroupMap[GroupName] = {};
 
-		std::vector<std::shared_ptr<CModel>> Models;
 		const auto& GroupItems = iter->value.GetArray();
 		for (auto& Item : GroupItems)
 		{
 			_ASSERTE(Item.HasMember("filePath"));
-			std::string FilePath = Item["filePath"].GetString();
-			std::shared_ptr<CModel> pModel = std::make_shared<CModel>(FilePath);
+
+			SModelItem ModelItem;
+			ModelItem.GroupName = GroupName;
+			ModelItem.FilePath = Item["filePath"].GetString();
 			if (Item.HasMember("position"))
 			{
 				auto Array = Item["position"].GetArray();
 				_ASSERTE(Array.Size() == 3);
-				pModel->setPosition(glm::vec3(Array[0].GetFloat(), Array[1].GetFloat(), Array[2].GetFloat()));
+				ModelItem.Transform.setPosition(glm::vec3(Array[0].GetFloat(), Array[1].GetFloat(), Array[2].GetFloat()));
 			}
 			if (Item.HasMember("scale"))
 			{
 				auto Array = Item["scale"].GetArray();
 				_ASSERTE(Array.Size() == 3);
-				pModel->setScale(glm::vec3(Array[0].GetFloat(), Array[1].GetFloat(), Array[2].GetFloat()));
+				ModelItem.Transform.setScale(glm::vec3(Array[0].GetFloat(), Array[1].GetFloat(), Array[2].GetFloat()));
 			}
 			if (Item.HasMember("rotation"))
 			{
@@ -55,19 +106,93 @@ void CScene::__parseModels(const rapidjson::Value& vValue)
 				float Angle = v["angle"].GetFloat();
 				auto  Axis = v["axis"].GetArray();
 				_ASSERTE(Axis.Size() == 3);
-				pModel->setRotation(Angle, glm::vec3(Axis[0].GetFloat(), Axis[1].GetFloat(), Axis[2].GetFloat()));
+				ModelItem.Transform.setRotation(Angle, glm::vec3(Axis[0].GetFloat(), Axis[1].GetFloat(), Axis[2].GetFloat()));
 			}
 			if (Item.HasMember("parameters"))
 			{
 				auto Array = Item["parameters"].GetArray();
 				_ASSERTE(Array.Size() == 4);
-				pModel->setParameters(glm::vec4(Array[0].GetFloat(), Array[1].GetFloat(), Array[2].GetFloat(), Array[3].GetFloat()));
+				ModelItem.Transform.setParameters(glm::vec4(Array[0].GetFloat(), Array[1].GetFloat(), Array[2].GetFloat(), Array[3].GetFloat()));
 			}
 
-			Models.push_back(pModel);
+			__importModel(ModelItem.FilePath);
+			m_PendingItems.push_back(ModelItem);
 		}
+	}
+}
 
-		_ASSERTE(m_ModelGroupMap.find(GroupName) == m_ModelGroupMap.end());
-		m_ModelGroupMap[GroupName] = Models;
+//************************************************************
+//FUNCTION: every distinct file is imported at most once, and not at all if its asset is still alive in the registry
+void CScene::__importModel(const std::string& vFilePath)
+{
+	if (m_ImportingAssets.find(vFilePath) != m_ImportingAssets.end()) return;
+
+	std::string FilePath = CFileLocator::getInstance()->locateFile(vFilePath);
+	if (FilePath.empty()) { _OUTPUT_WARNING(format("Failed to locate model %s.", vFilePath.c_str())); _ASSERTE(false); return; }
+
+	bool IsCreated = false;
+	std::shared_ptr<CModelAsset> pAsset = CModelAssetRegistry::getInstance()->getOrCreateAsset(FilePath, m_LoadOptions, IsCreated);
+	m_ImportingAssets[vFilePath] = pAsset;
+	if (!IsCreated) return;
+
+	m_NumPendingImports++;
+
+	CThreadPool::getInstance()->submit([this, pAsset]()
+	{
+		SImportResult Result;
+		Result.pAsset = pAsset;
+		Result.IsSucceeded = pAsset->_import();
+		{
+			std::lock_guard<std::mutex> Lock(m_UploadQueueMutex);
+			m_UploadQueue.push_back(Result);
+		}
+		m_UploadQueueCondition.notify_one();
+	});
+}
+
+//************************************************************
+//FUNCTION:
+void CScene::__uploadImportedModels()
+{
+	std::deque<SImportResult> ImportResults;
+	{
+		std::lock_guard<std::mutex> Lock(m_UploadQueueMutex);
+		ImportResults.swap(m_UploadQueue);
+	}
+
+	for (const auto& Result : ImportResults)
+	{
+		if (Result.IsSucceeded) Result.pAsset->_upload();
+		else
+		{
+			CModelAssetRegistry::getInstance()->removeFailedAsset(Result.pAsset);
+			_OUTPUT_WARNING(format("Failed to load model at %s.", Result.pAsset->getFilePath().c_str()));
+			_ASSERTE(false);
+		}
+
+		_ASSERTE(m_NumPendingImports > 0);
+		m_NumPendingImports--;
+	}
+}
+
+//************************************************************
+//FUNCTION: the items placed from the same file become instances sharing one asset
+void CScene::__finishLoading()
+{
+	for (const auto& Item : m_PendingItems)
+	{
+		auto iter = m_ImportingAssets.find(Item.FilePath);
+		if (iter == m_ImportingAssets.end()) continue;
+
+		std::shared_ptr<CModel> pModel(new CModel(iter->second));
+		static_cast<CEntity&>(*pModel) = Item.Transform;
+		m_ModelGroupMap[Item.GroupName].push_back(pModel);
 	}
+
+	m_PendingItems.clear();
+	m_ImportingAssets.clear();
+
+	m_LoadedPromise.set_value();
+	if (m_OnLoadedCallback) m_OnLoadedCallback();
+	m_OnLoadedCallback = nullptr;
 }
\ No newline at end of file
@@ -3,24 +3,66 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
 #include "JsonUtil.h"
+#include "Entity.h"
+#include "Model.h"
 #include "Export.h"
 
 namespace glt
 {
-	class CModel;
-
 	using ModelGroup = std::vector<std::shared_ptr<CModel>>;
 
 	class GLT_DECLSPEC CScene
 	{
 	public:
-		void load(const std::string& vFilePath);
+		CScene() = default;
+		~CScene();
+
+		void load(const std::string& vFilePath, const SModelLoadOptions& vOptions = SModelLoadOptions());
+		std::future<void> loadAsync(const std::string& vFilePath, std::function<void()> vOnLoadedCallback = nullptr, const SModelLoadOptions& vOptions = SModelLoadOptions());
+		void update();
+
+		bool isLoading() const { return m_NumPendingImports > 0; }
+
 		const ModelGroup& getModelGroup(const std::string& vGroupName) const;
 
 	private:
-		std::unordered_map<std::string, ModelGroup> m_ModelGroupMap;
+		_DISALLOW_COPY_AND_ASSIGN(CScene);
+
+		struct SModelItem
+		{
+			std::string GroupName;
+			std::string FilePath;
+			CEntity Transform;
+		};
+
+		struct SImportResult
+		{
+			std::shared_ptr<CModelAsset> pAsset;
+			bool IsSucceeded = false;
+		};
 
 		void __parseModels(const rapidjson::Value& vValue);
+		void __importModel(const std::string& vFilePath);
+		void __uploadImportedModels();
+		void __finishLoading();
+
+		std::unordered_map<std::string, ModelGroup> m_ModelGroupMap;
+
+		SModelLoadOptions m_LoadOptions;
+		std::vector<SModelItem> m_PendingItems;
+		std::unordered_map<std::string, std::shared_ptr<CModelAsset>> m_ImportingAssets;
+		unsigned m_NumPendingImports = 0;
+		std::promise<void> m_LoadedPromise;
+		std::function<void()> m_OnLoadedCallback;
+
+		std::deque<SImportResult> m_UploadQueue;
+		std::mutex m_UploadQueueMutex;
+		std::condition_variable m_UploadQueueCondition;
 	};
 }
\ No newline at end of file
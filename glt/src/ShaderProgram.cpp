@@ -5,7 +5,9 @@
 #include "Common.h"
 #include "Texture.h"
 #include "FileLocator.h"
+#include "FileSystem.h"
 #include "Utility.h"
+#include "Renderer.h"
 
 using namespace glt;
 
@@ -23,6 +25,20 @@ CShaderProgram::~CShaderProgram()
 	glDeleteProgram(m_ProgramID);
 }
 
+//********************************************************************
+//FUNCTION: goes through the renderer, which skips binding the program that is already bound
+void CShaderProgram::bind() const
+{
+	CRenderer::getInstance()->_useProgram(m_ProgramID);
+}
+
+//********************************************************************
+//FUNCTION:
+void CShaderProgram::unbind() const
+{
+	CRenderer::getInstance()->_useProgram(0);
+}
+
 //*********************************************************************************
 //FUNCTION:
 void CShaderProgram::addShader(const std::string& vShaderName, EShaderType vShaderType)
@@ -47,6 +63,15 @@ void CShaderProgram::addShader(const std::string& vShaderName, EShaderType vShad
 	__linkProgram(m_ProgramID);
 }
 
+//*********************************************************************
+//FUNCTION: uniforms the linker removed as unused do not exist either
+bool CShaderProgram::hasUniform(const std::string& vName) const
+{
+	auto Iter = m_UniformLocCacheMap.find(vName);
+	if (Iter == m_UniformLocCacheMap.end()) Iter = m_UniformLocCacheMap.emplace(vName, glGetUniformLocation(m_ProgramID, vName.c_str())).first;
+	return Iter->second != -1;
+}
+
 //*********************************************************************
 //FUNCTION:
 void CShaderProgram::updateUniform1i(const std::string& vName, int vValue) const
@@ -142,10 +167,14 @@ std::string CShaderProgram::__readShaderFile(const std::string& vFileName) const
 			ltrim(LineBuffer);
 			LineBuffer = LineBuffer.substr(1, LineBuffer.size() - 2);
 
-			// The include path is relative to the current shader file path
+			// The include path is relative to the current shader file path, files not found there
+			// are looked up among the built-in shaders, such as frame_uniforms.glsl
 			std::string pathOfThisFile;
 			__getFilePath(vFileName, pathOfThisFile);
-			LineBuffer.insert(0, pathOfThisFile);
+			if (CFileSystem::getInstance()->isFileExisted(pathOfThisFile + LineBuffer))
+				LineBuffer.insert(0, pathOfThisFile);
+			else
+				LineBuffer = CFileLocator::getInstance()->locateFile("shaders/" + LineBuffer);
 
 			// By using recursion, the new include file can be extracted
 			// and inserted at this location in the shader source code
@@ -23,12 +23,13 @@ namespace glt
 		CShaderProgram();
 		~CShaderProgram();
 
-		void bind() const { glUseProgram(m_ProgramID); }
-		void unbind() const { glUseProgram(0); }
+		void bind() const;
+		void unbind() const;
 
 		void addShader(const std::string& vShaderName, EShaderType vShaderType);
 
 		unsigned int getProgramID() const { return m_ProgramID; }
+		bool hasUniform(const std::string& vName) const;
 
 		void updateUniform1i(const std::string& vName, int vValue) const;
 		void updateUniformTexture(const std::string& vName, const CTexture* vTexture) const;
@@ -1,11 +1,12 @@
 #include "ShaderStorageBuffer.h"
 #include <glad/glad.h>
+#include "Common.h"
 
 using namespace glt;
 
 //********************************************************************
 //FUNCTION:
-CShaderStorageBuffer::CShaderStorageBuffer(const void* vData, unsigned int vSize, unsigned int vBindPoint)
+CShaderStorageBuffer::CShaderStorageBuffer(const void* vData, unsigned int vSize, unsigned int vBindPoint) : m_Size(vSize), m_BindPoint(vBindPoint)
 {
 	glGenBuffers(1, &m_ObjectID);
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, vBindPoint, m_ObjectID);
@@ -31,4 +32,21 @@ void CShaderStorageBuffer::bind() const
 void CShaderStorageBuffer::unbind() const
 {
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+//********************************************************************
+//FUNCTION:
+void CShaderStorageBuffer::bindBase() const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_BindPoint, m_ObjectID);
+}
+
+//********************************************************************
+//FUNCTION:
+void CShaderStorageBuffer::update(const void* vData, unsigned int vSize, unsigned int vOffset) const
+{
+	_ASSERTE(vOffset + vSize <= m_Size);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ObjectID);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, vOffset, vSize, vData);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
\ No newline at end of file
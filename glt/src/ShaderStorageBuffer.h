@@ -11,8 +11,14 @@ namespace glt
 
 		void bind() const;
 		void unbind() const;
+		void bindBase() const;
+		void update(const void* vData, unsigned int vSize, unsigned int vOffset = 0) const;
+
+		unsigned int getSize() const { return m_Size; }
 
 	private:
 		unsigned int m_ObjectID = 0;
+		unsigned int m_Size = 0;
+		unsigned int m_BindPoint = 0;
 	};
 }
\ No newline at end of file
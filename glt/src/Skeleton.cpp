@@ -0,0 +1,201 @@
+#include "Skeleton.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Common.h"
+#include "CpuFeatures.h"
+#include "SkeletonKernels.h"
+
+using namespace glt;
+
+//***********************************************************************************************
+//FUNCTION: returns the key starting the segment that contains vAnimationTime. The segment found last time (vHint) and
+//          the one after it are tried first since playback moves forward a little every frame, anything else, like
+//          the clip looping back to its start, falls back to a binary search
+static unsigned __findKey(const std::vector<float>& vTimes, float vAnimationTime, unsigned vHint)
+{
+	unsigned NumKeys = static_cast<unsigned>(vTimes.size());
+	_ASSERTE(NumKeys > 1);
+
+	if (vHint + 1 < NumKeys && vAnimationTime >= vTimes[vHint])
+	{
+		if (vAnimationTime < vTimes[vHint + 1]) return vHint;
+		if (vHint + 2 < NumKeys && vAnimationTime < vTimes[vHint + 2]) return vHint + 1;
+	}
+
+	auto Iter = std::upper_bound(vTimes.begin() + 1, vTimes.end() - 1, vAnimationTime);
+	return static_cast<unsigned>(Iter - vTimes.begin()) - 1;
+}
+
+//***********************************************************************************************
+//FUNCTION: picks the two keys around vAnimationTime and returns the blend factor between them. The factor is clamped so
+//          that a time past the last key holds the last value instead of extrapolating
+static float __findKeyPair(const std::vector<float>& vTimes, float vAnimationTime, unsigned& vioKey, unsigned& voStart, unsigned& voEnd)
+{
+	_ASSERTE(!vTimes.empty());
+	if (vTimes.size() == 1)
+	{
+		voStart = voEnd = 0;
+		return 0.0f;
+	}
+
+	vioKey = __findKey(vTimes, vAnimationTime, vioKey);
+	voStart = vioKey;
+	voEnd = vioKey + 1;
+
+	float DeltaTime = vTimes[voEnd] - vTimes[voStart];
+	return (DeltaTime > 0.0f) ? glm::clamp((vAnimationTime - vTimes[voStart]) / DeltaTime, 0.0f, 1.0f) : 0.0f;
+}
+
+//***********************************************************************************************
+//FUNCTION: voResult may alias either operand
+static void __multiply(const glm::mat4& vA, const glm::mat4& vB, glm::mat4& voResult, EPoseKernel vKernel)
+{
+#ifdef GLT_POSE_SSE
+	if (vKernel == EPoseKernel::SIMD)
+	{
+		__m128 A0 = _mm_loadu_ps(&vA[0][0]), A1 = _mm_loadu_ps(&vA[1][0]), A2 = _mm_loadu_ps(&vA[2][0]), A3 = _mm_loadu_ps(&vA[3][0]);
+		__m128 Columns[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			Columns[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(A0, _mm_set1_ps(vB[i][0])), _mm_mul_ps(A1, _mm_set1_ps(vB[i][1]))),
+				_mm_add_ps(_mm_mul_ps(A2, _mm_set1_ps(vB[i][2])), _mm_mul_ps(A3, _mm_set1_ps(vB[i][3]))));
+		}
+		for (int i = 0; i < 4; ++i) _mm_storeu_ps(&voResult[i][0], Columns[i]);
+		return;
+	}
+#endif
+	voResult = vA * vB;
+}
+
+//***********************************************************************************************
+//FUNCTION:
+CSkeleton::CSkeleton(const std::vector<SSkeletonNode>& vNodes, const std::vector<glm::mat4>& vBoneOffsets, const glm::mat4& vGlobalInverseTransform)
+	: m_Nodes(vNodes), m_BoneOffsets(vBoneOffsets), m_GlobalInverseTransform(vGlobalInverseTransform)
+{
+#ifdef _DEBUG
+	for (size_t i = 0; i < m_Nodes.size(); ++i) _ASSERTE(m_Nodes[i].Parent < static_cast<int>(i));
+#endif
+}
+
+//***********************************************************************************************
+//FUNCTION: the clip must use the channel indices of this skeleton, nodes whose channel is empty in the clip keep their
+//          bind transform and bones that are not part of the hierarchy keep the identity. The global inverse transform
+//          is applied to the roots, so the global transforms in the workspace already include it
+void CSkeleton::evaluatePose(const SAnimationClip& vClip, float vTimeInSeconds, SPoseWorkspace& vioWorkspace, std::vector<glm::mat4>& voBoneTransforms, EPoseKernel vKernel) const
+{
+	float TimeInTicks = vTimeInSeconds * vClip.TicksPerSecond;
+	float AnimationTime = (vClip.Duration > 0.0f) ? std::fmod(TimeInTicks, vClip.Duration) : 0.0f;
+	if (AnimationTime < 0.0f) AnimationTime += vClip.Duration;
+
+	_ASSERTE(std::all_of(m_Nodes.begin(), m_Nodes.end(), [&](const SSkeletonNode& vNode) { return vNode.Channel < static_cast<int>(vClip.Channels.size()); }));
+	__gatherSamples(vClip, AnimationTime, vioWorkspace);
+
+	unsigned NumChannels = static_cast<unsigned>(vClip.Channels.size());
+	if (vKernel == EPoseKernel::Scalar || !__blendSamplesSIMD(vioWorkspace.Samples.data(), vioWorkspace.SampleStride, NumChannels))
+		__blendSamples<SScalarLanes>(vioWorkspace.Samples.data(), vioWorkspace.SampleStride, 0, NumChannels);
+
+	vioWorkspace.GlobalTransforms.resize(m_Nodes.size());
+	voBoneTransforms.assign(m_BoneOffsets.size(), glm::mat4(1.0f));
+
+	const float* pMatrices = vioWorkspace.Samples.data() + MATRIX * vioWorkspace.SampleStride;
+	for (size_t i = 0; i < m_Nodes.size(); ++i)
+	{
+		const SSkeletonNode& Node = m_Nodes[i];
+
+		glm::mat4 NodeTransformation = Node.Transform;
+		if (Node.Channel >= 0 && !vClip.Channels[Node.Channel].Rotations.Times.empty())
+		{
+			for (int Column = 0; Column < 4; ++Column)
+			{
+				for (int Row = 0; Row < 3; ++Row) NodeTransformation[Column][Row] = pMatrices[(Column * 3 + Row) * vioWorkspace.SampleStride + Node.Channel];
+				NodeTransformation[Column][3] = (Column == 3) ? 1.0f : 0.0f;
+			}
+		}
+
+		glm::mat4& GlobalTransformation = vioWorkspace.GlobalTransforms[i];
+		__multiply((Node.Parent >= 0) ? vioWorkspace.GlobalTransforms[Node.Parent] : m_GlobalInverseTransform, NodeTransformation, GlobalTransformation, vKernel);
+
+		if (Node.Bone >= 0) __multiply(GlobalTransformation, m_BoneOffsets[Node.Bone], voBoneTransforms[Node.Bone], vKernel);
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION: the widest instruction set the SIMD kernel runs with on this CPU
+const char* CSkeleton::getSIMDInstructionSet()
+{
+	if (isAVX2Supported() && __blendSamplesAVX2(nullptr, 0, 0)) return "AVX2";
+#if defined(GLT_POSE_SSE)
+	return "SSE2";
+#else
+	return "none";
+#endif
+}
+
+//***********************************************************************************************
+//FUNCTION: picks the AVX2 kernel at runtime where the CPU supports it, returns false when there is no SIMD kernel at all
+bool CSkeleton::__blendSamplesSIMD(float* vioSamples, unsigned vStride, unsigned vNumChannels)
+{
+	if (isAVX2Supported() && __blendSamplesAVX2(vioSamples, vStride, vNumChannels)) return true;
+#if defined(GLT_POSE_SSE)
+	__blendSamples<SSSELanes>(vioSamples, vStride, 0, vNumChannels);
+	return true;
+#else
+	return false;
+#endif
+}
+
+//***********************************************************************************************
+//FUNCTION: the key search stays scalar, it only writes the two keys and the factor of every channel into the streams.
+//          Channels past the end of the clip are padding for the widest kernel and hold the identity
+void CSkeleton::__gatherSamples(const SAnimationClip& vClip, float vAnimationTime, SPoseWorkspace& vioWorkspace)
+{
+	unsigned NumChannels = static_cast<unsigned>(vClip.Channels.size());
+	unsigned Stride = (NumChannels + SAMPLE_ALIGNMENT - 1) / SAMPLE_ALIGNMENT * SAMPLE_ALIGNMENT;
+	if (vioWorkspace.SampleStride != Stride || vioWorkspace.Samples.size() != Stride * NUM_SAMPLE_STREAMS)
+	{
+		vioWorkspace.SampleStride = Stride;
+		vioWorkspace.Samples.assign(Stride * NUM_SAMPLE_STREAMS, 0.0f);
+		for (unsigned i = 0; i < Stride; ++i)
+		{
+			for (unsigned k = 0; k < 3; ++k) vioWorkspace.Samples[(SCALING_A + k) * Stride + i] = vioWorkspace.Samples[(SCALING_B + k) * Stride + i] = 1.0f;
+			vioWorkspace.Samples[(ROTATION_A + 3) * Stride + i] = vioWorkspace.Samples[(ROTATION_B + 3) * Stride + i] = 1.0f;
+		}
+	}
+	vioWorkspace.Cursors.resize(NumChannels);
+
+	float* pSamples = vioWorkspace.Samples.data();
+	for (unsigned i = 0; i < NumChannels; ++i)
+	{
+		const SAnimationChannel& Channel = vClip.Channels[i];
+		if (Channel.Rotations.Times.empty()) continue;
+		SChannelCursor& Cursor = vioWorkspace.Cursors[i];
+
+		unsigned Start = 0, End = 0;
+		pSamples[POSITION_FACTOR * Stride + i] = __findKeyPair(Channel.Positions.Times, vAnimationTime, Cursor.PositionKey, Start, End);
+		glm::vec3 PositionStart = Channel.Positions.decode(Start), PositionEnd = Channel.Positions.decode(End);
+		for (int k = 0; k < 3; ++k)
+		{
+			pSamples[(POSITION_A + k) * Stride + i] = PositionStart[k];
+			pSamples[(POSITION_B + k) * Stride + i] = PositionEnd[k];
+		}
+
+		pSamples[SCALING_FACTOR * Stride + i] = __findKeyPair(Channel.Scalings.Times, vAnimationTime, Cursor.ScalingKey, Start, End);
+		glm::vec3 ScalingStart = Channel.Scalings.decode(Start), ScalingEnd = Channel.Scalings.decode(End);
+		for (int k = 0; k < 3; ++k)
+		{
+			pSamples[(SCALING_A + k) * Stride + i] = ScalingStart[k];
+			pSamples[(SCALING_B + k) * Stride + i] = ScalingEnd[k];
+		}
+
+		pSamples[ROTATION_FACTOR * Stride + i] = __findKeyPair(Channel.Rotations.Times, vAnimationTime, Cursor.RotationKey, Start, End);
+		glm::quat RotationStart = Channel.Rotations.decode(Start), RotationEnd = Channel.Rotations.decode(End);
+		const float RotationA[4] = { RotationStart.x, RotationStart.y, RotationStart.z, RotationStart.w };
+		const float RotationB[4] = { RotationEnd.x, RotationEnd.y, RotationEnd.z, RotationEnd.w };
+		for (int k = 0; k < 4; ++k)
+		{
+			pSamples[(ROTATION_A + k) * Stride + i] = RotationA[k];
+			pSamples[(ROTATION_B + k) * Stride + i] = RotationB[k];
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "Export.h"
+
+namespace glt
+{
+	//NOTE: the keys of a channel as imported, before compression
+	struct SVectorKey
+	{
+		float Time = 0.0f;
+		glm::vec3 Value = glm::vec3(0.0f);
+	};
+
+	struct SRotationKey
+	{
+		float Time = 0.0f;
+		glm::quat Value = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	};
+
+	//NOTE: the keys of a track as stored at runtime. Every component is quantized to 16 bits over the range the track
+	//      covers in its clip
+	struct SVectorTrack
+	{
+		std::vector<float> Times;
+		std::vector<std::array<unsigned short, 3>> Values;
+		glm::vec3 Min = glm::vec3(0.0f);
+		glm::vec3 Extent = glm::vec3(0.0f);
+
+		glm::vec3 decode(unsigned vKey) const
+		{
+			const auto& Value = Values[vKey];
+			return Min + Extent * glm::vec3(Value[0], Value[1], Value[2]) * (1.0f / 65535.0f);
+		}
+	};
+
+	//NOTE: rotations are stored as the smallest three components in 48 bits. The largest component is made positive and
+	//      rebuilt from the unit length, the other three take 15 bits each and the low bits of the first two words hold
+	//      the index of the dropped one
+	struct SRotationTrack
+	{
+		std::vector<float> Times;
+		std::vector<std::array<unsigned short, 3>> Values;
+
+		glm::quat decode(unsigned vKey) const
+		{
+			const auto& Value = Values[vKey];
+			unsigned Largest = (Value[0] & 1u) | ((Value[1] & 1u) << 1);
+
+			float Components[4];
+			float SumOfSquares = 0.0f;
+			for (unsigned i = 0, k = 0; i < 4; ++i)
+			{
+				if (i == Largest) continue;
+				Components[i] = ((Value[k++] >> 1) * (2.0f / 32767.0f) - 1.0f) * 0.70710678f;
+				SumOfSquares += Components[i] * Components[i];
+			}
+			Components[Largest] = std::sqrt(std::max(1.0f - SumOfSquares, 0.0f));
+
+			return glm::quat(Components[3], Components[0], Components[1], Components[2]);
+		}
+	};
+
+	//NOTE: a channel is either empty, for a node the clip does not animate, or has at least one key of each kind
+	struct SAnimationChannel
+	{
+		SVectorTrack Positions;
+		SRotationTrack Rotations;
+		SVectorTrack Scalings;
+	};
+
+	//NOTE: key times and the duration are in ticks
+	struct SAnimationClip
+	{
+		std::string Name;
+		float Duration = 0.0f;
+		float TicksPerSecond = 25.0f;
+		std::vector<SAnimationChannel> Channels;
+	};
+
+	//NOTE: Parent, Channel and Bone are -1 for the root, a node without animation and a node that is not a bone
+	struct SSkeletonNode
+	{
+		int Parent = -1;
+		int Channel = -1;
+		int Bone = -1;
+		glm::mat4 Transform = glm::mat4(1.0f);
+	};
+
+	//NOTE: the keys an animation channel was sampled between last time, playing forward usually finds the next keys right there
+	struct SChannelCursor
+	{
+		unsigned PositionKey = 0;
+		unsigned RotationKey = 0;
+		unsigned ScalingKey = 0;
+	};
+
+	//NOTE: the scratch memory of one animated instance, sized on first use so that evaluating a pose does not allocate.
+	//      Samples holds the sampled keys of all channels as structure of arrays, one stream of SampleStride floats per
+	//      key component, so that the SIMD kernels blend several channels at once
+	struct SPoseWorkspace
+	{
+		std::vector<SChannelCursor> Cursors;
+		std::vector<glm::mat4> GlobalTransforms;
+		std::vector<float> Samples;
+		unsigned SampleStride = 0;
+	};
+
+	enum class EPoseKernel : unsigned char
+	{
+		SIMD = 0,
+		Scalar,
+	};
+
+	//NOTE: the node hierarchy compiled at load time. Nodes are stored parents first with their channel and bone already
+	//      resolved, so a pose is one forward pass over an array without strings, lookups or recursion. Rotations are
+	//      blended with nlerp, which stays within a fraction of a degree of slerp for the key spacing of sampled clips
+	class GLT_DECLSPEC CSkeleton
+	{
+	public:
+		CSkeleton() = default;
+		CSkeleton(const std::vector<SSkeletonNode>& vNodes, const std::vector<glm::mat4>& vBoneOffsets, const glm::mat4& vGlobalInverseTransform);
+
+		bool isEmpty() const { return m_Nodes.empty(); }
+		unsigned getNumNodes() const { return static_cast<unsigned>(m_Nodes.size()); }
+		unsigned getNumBones() const { return static_cast<unsigned>(m_BoneOffsets.size()); }
+		const std::vector<SSkeletonNode>& getNodes() const { return m_Nodes; }
+
+		void evaluatePose(const SAnimationClip& vClip, float vTimeInSeconds, SPoseWorkspace& vioWorkspace, std::vector<glm::mat4>& voBoneTransforms,
+			EPoseKernel vKernel = EPoseKernel::SIMD) const;
+
+		static const char* getSIMDInstructionSet();
+
+	private:
+		static void __gatherSamples(const SAnimationClip& vClip, float vAnimationTime, SPoseWorkspace& vioWorkspace);
+		static bool __blendSamplesSIMD(float* vioSamples, unsigned vStride, unsigned vNumChannels);
+		static bool __blendSamplesAVX2(float* vioSamples, unsigned vStride, unsigned vNumChannels);
+
+		std::vector<SSkeletonNode> m_Nodes;
+		std::vector<glm::mat4> m_BoneOffsets;
+		glm::mat4 m_GlobalInverseTransform = glm::mat4(1.0f);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "Skeleton.h"
+#include <cmath>
+#include <immintrin.h>
+
+//NOTE: glt.vcxproj compiles this file alone with /arch:AVX2, the kernel is only called once isAVX2Supported() said so.
+//      GCC and Clang builds enable AVX2 for the code below the includes only
+#if defined(__AVX2__)
+#define GLT_POSE_AVX2
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#pragma GCC target("avx2")
+#define GLT_POSE_AVX2
+#endif
+
+#include "SkeletonKernels.h"
+
+using namespace glt;
+
+#if defined(GLT_POSE_AVX2)
+namespace
+{
+	struct SAVX2Lanes
+	{
+		using Type = __m256;
+		static constexpr unsigned Width = 8;
+
+		static Type load(const float* vData) { return _mm256_loadu_ps(vData); }
+		static void store(float* voData, Type vValue) { _mm256_storeu_ps(voData, vValue); }
+		static Type set(float vValue) { return _mm256_set1_ps(vValue); }
+		static Type add(Type vA, Type vB) { return _mm256_add_ps(vA, vB); }
+		static Type sub(Type vA, Type vB) { return _mm256_sub_ps(vA, vB); }
+		static Type mul(Type vA, Type vB) { return _mm256_mul_ps(vA, vB); }
+		static Type div(Type vA, Type vB) { return _mm256_div_ps(vA, vB); }
+		static Type sqrt(Type vA) { return _mm256_sqrt_ps(vA); }
+		static Type negateIfNegative(Type vA, Type vSign) { return _mm256_xor_ps(vA, _mm256_and_ps(vSign, _mm256_set1_ps(-0.0f))); }
+	};
+}
+#endif
+
+//***********************************************************************************************
+//FUNCTION: returns false when this file was not compiled for AVX2, a call without samples only asks for that
+bool CSkeleton::__blendSamplesAVX2(float* vioSamples, unsigned vStride, unsigned vNumChannels)
+{
+#if defined(GLT_POSE_AVX2)
+	if (vioSamples) __blendSamples<SAVX2Lanes>(vioSamples, vStride, 0, vNumChannels);
+	return true;
+#else
+	return false;
+#endif
+}
\ No newline at end of file
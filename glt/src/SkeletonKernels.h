@@ -0,0 +1,131 @@
+#pragma once
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GLT_POSE_SSE
+#endif
+
+//NOTE: the pose blending kernel shared by Skeleton.cpp and SkeletonAVX2.cpp, which is compiled for AVX2. Everything here
+//      has internal linkage, so no function compiled for AVX2 can be picked by the linker for another translation unit
+namespace
+{
+	//NOTE: the streams of SPoseWorkspace::Samples. The kernels overwrite nothing but the affine matrix streams, column
+	//      major with the implicit fourth row (0, 0, 0, 1) left out
+	enum ESampleStream : unsigned
+	{
+		POSITION_A = 0,
+		POSITION_B = 3,
+		SCALING_A = 6,
+		SCALING_B = 9,
+		ROTATION_A = 12,
+		ROTATION_B = 16,
+		POSITION_FACTOR = 20,
+		ROTATION_FACTOR = 21,
+		SCALING_FACTOR = 22,
+		MATRIX = 23,
+		NUM_SAMPLE_STREAMS = 35,
+	};
+
+	constexpr unsigned SAMPLE_ALIGNMENT = 8;
+
+	struct SScalarLanes
+	{
+		using Type = float;
+		static constexpr unsigned Width = 1;
+
+		static Type load(const float* vData) { return *vData; }
+		static void store(float* voData, Type vValue) { *voData = vValue; }
+		static Type set(float vValue) { return vValue; }
+		static Type add(Type vA, Type vB) { return vA + vB; }
+		static Type sub(Type vA, Type vB) { return vA - vB; }
+		static Type mul(Type vA, Type vB) { return vA * vB; }
+		static Type div(Type vA, Type vB) { return vA / vB; }
+		static Type sqrt(Type vA) { return std::sqrt(vA); }
+		static Type negateIfNegative(Type vA, Type vSign) { return (vSign < 0.0f) ? -vA : vA; }
+	};
+
+#ifdef GLT_POSE_SSE
+	struct SSSELanes
+	{
+		using Type = __m128;
+		static constexpr unsigned Width = 4;
+
+		static Type load(const float* vData) { return _mm_loadu_ps(vData); }
+		static void store(float* voData, Type vValue) { _mm_storeu_ps(voData, vValue); }
+		static Type set(float vValue) { return _mm_set1_ps(vValue); }
+		static Type add(Type vA, Type vB) { return _mm_add_ps(vA, vB); }
+		static Type sub(Type vA, Type vB) { return _mm_sub_ps(vA, vB); }
+		static Type mul(Type vA, Type vB) { return _mm_mul_ps(vA, vB); }
+		static Type div(Type vA, Type vB) { return _mm_div_ps(vA, vB); }
+		static Type sqrt(Type vA) { return _mm_sqrt_ps(vA); }
+		static Type negateIfNegative(Type vA, Type vSign) { return _mm_xor_ps(vA, _mm_and_ps(vSign, _mm_set1_ps(-0.0f))); }
+	};
+#endif
+
+	//***********************************************************************************************
+	//FUNCTION: blends the gathered key pairs of the channels [vBegin, vEnd) and turns them into affine matrices. Translation
+	//          and scaling are lerped, rotations nlerped along the shorter arc, and the matrix is written straight from
+	//          the quaternion with the scaling folded into its columns instead of multiplying T * R * S
+	template <typename TLanes>
+	void __blendSamples(float* vioSamples, unsigned vStride, unsigned vBegin, unsigned vEnd)
+	{
+		using L = TLanes;
+		using T = typename TLanes::Type;
+		auto Stream = [vioSamples, vStride](unsigned vStream, unsigned vChannel) { return vioSamples + vStream * vStride + vChannel; };
+
+		const T One = L::set(1.0f);
+		const T Two = L::set(2.0f);
+
+		for (unsigned i = vBegin; i < vEnd; i += L::Width)
+		{
+			T Translation[3], Scaling[3], Rotation[4];
+
+			T PositionFactor = L::load(Stream(POSITION_FACTOR, i));
+			T ScalingFactor = L::load(Stream(SCALING_FACTOR, i));
+			for (unsigned k = 0; k < 3; ++k)
+			{
+				T PositionA = L::load(Stream(POSITION_A + k, i));
+				Translation[k] = L::add(PositionA, L::mul(PositionFactor, L::sub(L::load(Stream(POSITION_B + k, i)), PositionA)));
+				T ScalingA = L::load(Stream(SCALING_A + k, i));
+				Scaling[k] = L::add(ScalingA, L::mul(ScalingFactor, L::sub(L::load(Stream(SCALING_B + k, i)), ScalingA)));
+			}
+
+			T RotationA[4], RotationB[4];
+			T Dot = L::set(0.0f);
+			for (unsigned k = 0; k < 4; ++k)
+			{
+				RotationA[k] = L::load(Stream(ROTATION_A + k, i));
+				RotationB[k] = L::load(Stream(ROTATION_B + k, i));
+				Dot = L::add(Dot, L::mul(RotationA[k], RotationB[k]));
+			}
+
+			T RotationFactor = L::load(Stream(ROTATION_FACTOR, i));
+			T LengthSquared = L::set(0.0f);
+			for (unsigned k = 0; k < 4; ++k)
+			{
+				Rotation[k] = L::add(RotationA[k], L::mul(RotationFactor, L::sub(L::negateIfNegative(RotationB[k], Dot), RotationA[k])));
+				LengthSquared = L::add(LengthSquared, L::mul(Rotation[k], Rotation[k]));
+			}
+
+			T InverseLength = L::div(One, L::sqrt(LengthSquared));
+			T x = L::mul(Rotation[0], InverseLength), y = L::mul(Rotation[1], InverseLength);
+			T z = L::mul(Rotation[2], InverseLength), w = L::mul(Rotation[3], InverseLength);
+
+			T xx = L::mul(x, x), yy = L::mul(y, y), zz = L::mul(z, z);
+			T xy = L::mul(x, y), xz = L::mul(x, z), yz = L::mul(y, z);
+			T wx = L::mul(w, x), wy = L::mul(w, y), wz = L::mul(w, z);
+
+			L::store(Stream(MATRIX + 0, i), L::mul(Scaling[0], L::sub(One, L::mul(Two, L::add(yy, zz)))));
+			L::store(Stream(MATRIX + 1, i), L::mul(Scaling[0], L::mul(Two, L::add(xy, wz))));
+			L::store(Stream(MATRIX + 2, i), L::mul(Scaling[0], L::mul(Two, L::sub(xz, wy))));
+			L::store(Stream(MATRIX + 3, i), L::mul(Scaling[1], L::mul(Two, L::sub(xy, wz))));
+			L::store(Stream(MATRIX + 4, i), L::mul(Scaling[1], L::sub(One, L::mul(Two, L::add(xx, zz)))));
+			L::store(Stream(MATRIX + 5, i), L::mul(Scaling[1], L::mul(Two, L::add(yz, wx))));
+			L::store(Stream(MATRIX + 6, i), L::mul(Scaling[2], L::mul(Two, L::add(xz, wy))));
+			L::store(Stream(MATRIX + 7, i), L::mul(Scaling[2], L::mul(Two, L::sub(yz, wx))));
+			L::store(Stream(MATRIX + 8, i), L::mul(Scaling[2], L::sub(One, L::mul(Two, L::add(xx, yy)))));
+			for (unsigned k = 0; k < 3; ++k) L::store(Stream(MATRIX + 9 + k, i), Translation[k]);
+		}
+	}
+}
\ No newline at end of file
@@ -1,9 +1,11 @@
 #include "Skybox.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "ShaderProgram.h"
 #include "VertexBuffer.h"
 #include "VertexArray.h"
 #include "FileLocator.h"
+#include "Renderer.h"
 
 using namespace glt;
 
@@ -58,8 +60,7 @@ CSkybox::CSkybox(const std::vector<std::string>& vFaces)
 {
     _ASSERTE(!vFaces.empty());
 
-	m_pTexture = std::make_shared<CTextureCube>();
-	m_pTexture->load(vFaces, false);
+	m_pTexture = CTextureCache::getInstance()->loadTextureCube(vFaces, false);
 
 	m_pShaderProgram = std::make_shared<CShaderProgram>();
 
@@ -92,9 +93,9 @@ void CSkybox::_draw(unsigned int vBindPoint) const
     m_pVAO->bind();
 
     m_pShaderProgram->updateUniformTexture("uSkyboxTex", m_pTexture.get());
-    glDepthMask(GL_FALSE);
+    CRenderer::getInstance()->setDepthMask(false);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glDepthMask(GL_TRUE);
+    CRenderer::getInstance()->setDepthMask(true);
 
 #ifdef _DEBUG
     m_pVAO->unbind();
@@ -3,9 +3,18 @@
 #include "Common.h"
 #include "FileLocator.h"
 #include "ShaderProgram.h"
+#include "TextureStreamer.h"
 
 using namespace glt;
 
+//***********************************************************************************************
+//FUNCTION:
+static bool __isMipmapFilter(GLint vFilterMode)
+{
+	return vFilterMode == GL_NEAREST_MIPMAP_NEAREST || vFilterMode == GL_LINEAR_MIPMAP_NEAREST || vFilterMode == GL_NEAREST_MIPMAP_LINEAR
+		|| vFilterMode == GL_LINEAR_MIPMAP_LINEAR;
+}
+
 //***********************************************************************************************
 //FUNCTION:
 CTexture::CTexture()
@@ -34,24 +43,12 @@ void CTexture2D::load(const char* vPath, GLint vWrapMode, GLint vFilterMode, boo
 
 	glBindTexture(GL_TEXTURE_2D, m_ObjectID);
 
-	switch (Channels)
-	{
-	case 1:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, Width, Height, 0, GL_RED, GL_UNSIGNED_BYTE, pImageData);
-		break;
-	case 3:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, Width, Height, 0, GL_RGB, GL_UNSIGNED_BYTE, pImageData);
-		break;
-	case 4:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pImageData);
-		break;
-	default:
-		break;
-	}
+	m_FilterMode = vFilterMode;
+	__uploadImage(pImageData, Width, Height, Channels);
+	if (hasMipmaps()) glGenerateMipmap(GL_TEXTURE_2D);
 
 	if (!pImageData) _OUTPUT_WARNING("Failed to load texture due to failure of stbi_load().");
 
-	glGenerateMipmap(GL_TEXTURE_2D);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, vWrapMode);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, vWrapMode);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, vFilterMode);
@@ -59,6 +56,31 @@ void CTexture2D::load(const char* vPath, GLint vWrapMode, GLint vFilterMode, boo
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 	stbi_image_free(pImageData);
+
+	m_Status = pImageData ? ETextureStatus::Complete : ETextureStatus::Failed;
+}
+
+//***********************************************************************************************
+//FUNCTION: the image is decoded on a worker thread and uploaded by CTextureStreamer, the texture samples a 1x1 white
+//          placeholder until then. The texture must be owned by a std::shared_ptr
+void CTexture2D::loadAsync(const char* vPath, GLint vWrapMode, GLint vFilterMode, bool vFlipVertically)
+{
+	_ASSERTE(vPath);
+	m_FilePath = CFileLocator::getInstance()->locateFile(vPath);
+
+	const unsigned char Placeholder[4] = { 255, 255, 255, 255 };
+	m_FilterMode = vFilterMode;
+
+	glBindTexture(GL_TEXTURE_2D, m_ObjectID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, Placeholder);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, vWrapMode);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, vWrapMode);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, vFilterMode);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, vFilterMode);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	m_Status = ETextureStatus::Loading;
+	CTextureStreamer::getInstance()->request(shared_from_this(), vFlipVertically);
 }
 
 //***********************************************************************************************
@@ -102,6 +124,42 @@ void CTexture2D::load16(const char* vPath, GLint vWrapMode, GLint vFilterMode, b
 	stbi_image_free(pImageData);
 }
 
+//***********************************************************************************************
+//FUNCTION:
+bool CTexture2D::hasMipmaps() const
+{
+	return __isMipmapFilter(m_FilterMode);
+}
+
+//***********************************************************************************************
+//FUNCTION: the texture has to be bound, vImageData is either client memory or an offset into the bound pixel unpack buffer.
+//          Only the base level is uploaded, the caller generates the mip chain if the texture has one
+void CTexture2D::__uploadImage(const void* vImageData, int vWidth, int vHeight, int vChannels)
+{
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	switch (vChannels)
+	{
+	case 1:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, vWidth, vHeight, 0, GL_RED, GL_UNSIGNED_BYTE, vImageData);
+		break;
+	case 3:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, vWidth, vHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, vImageData);
+		break;
+	case 4:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, vWidth, vHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, vImageData);
+		break;
+	default:
+		break;
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	//NOTE: RGB8 is usually padded to four bytes by the driver, the mip chain adds another third
+	m_MemorySize = static_cast<size_t>(vWidth) * vHeight * (vChannels == 3 ? 4 : vChannels);
+	if (hasMipmaps()) m_MemorySize = m_MemorySize * 4 / 3;
+}
+
 //***********************************************************************************************
 //FUNCTION:
 void CTexture2D::createEmpty(unsigned int vWidth, unsigned int vHeight, GLint vInternalFormat, GLint vWrapMode, GLint vFilterMode, bool vGenerateMipMap)
@@ -159,6 +217,7 @@ void CTextureCube::load(const std::vector<std::string>& vFaces, bool vGenerateMi
 	{
 		pImageData = stbi_load(CFileLocator::getInstance()->locateFile(vFaces[i]).c_str(), &Width, &Height, &NrComponents, 0);
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB8, Width, Height, 0, GL_RGB, GL_UNSIGNED_BYTE, pImageData);
+		if (pImageData) m_MemorySize += static_cast<size_t>(Width) * Height * 4 * (vGenerateMipMap ? 4 : 3) / 3;
 		stbi_image_free(pImageData);
 	}
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -8,6 +8,14 @@
 
 namespace glt
 {
+	enum class ETextureStatus : unsigned char
+	{
+		Empty = 0,
+		Loading,
+		Complete,
+		Failed
+	};
+
 	class GLT_DECLSPEC CTexture
 	{
 	public:
@@ -23,23 +31,40 @@ namespace glt
 		const std::string& getTextureName() const { return m_TextureName; }
 		unsigned int getBindPoint() const { return m_BindPoint; }
 		unsigned int getObjectID() const { return m_ObjectID; }
+		size_t getMemorySize() const { return m_MemorySize; }
 
 	protected:
 		std::string m_FilePath = {};
 		std::string m_TextureName = {};
 		unsigned int m_ObjectID = 0;
+		size_t m_MemorySize = 0;
 		mutable unsigned int m_BindPoint = 0;
 	};
 
-	class GLT_DECLSPEC CTexture2D : public CTexture
+	class GLT_DECLSPEC CTexture2D : public CTexture, public std::enable_shared_from_this<CTexture2D>
 	{
 	public:
 		void load(const char *vPath, GLint vWrapMode = GL_CLAMP_TO_BORDER, GLint vFilterMode = GL_LINEAR, bool vFlipVertically = false);
+		void loadAsync(const char *vPath, GLint vWrapMode = GL_CLAMP_TO_BORDER, GLint vFilterMode = GL_LINEAR, bool vFlipVertically = false);
 		void load16(const char *vPath, GLint vWrapMode = GL_CLAMP_TO_BORDER, GLint vFilterMode = GL_LINEAR, bool vFlipVertically = false);
 		void createEmpty(unsigned int vWidth, unsigned int vHeight, GLint vInternalFormat = GL_RGBA, GLint vWrapMode = GL_CLAMP_TO_BORDER, GLint vFilterMode = GL_NEAREST, bool vGenerateMipMap = GL_FALSE);
 
 		void bindV(unsigned int vBindPoint) const override;
 		void unbindV() const override;
+
+		ETextureStatus getStatus() const { return m_Status; }
+		bool isComplete() const { return m_Status == ETextureStatus::Complete; }
+		bool hasMipmaps() const;
+
+	private:
+		void __uploadImage(const void* vImageData, int vWidth, int vHeight, int vChannels);
+
+		ETextureStatus m_Status = ETextureStatus::Empty;
+
+		//NOTE: the mip chain of a loaded texture is only generated if its minification filter samples it
+		GLint m_FilterMode = GL_LINEAR;
+
+		friend class CTextureStreamer;
 	};
 
 	class GLT_DECLSPEC CTextureCube : public CTexture
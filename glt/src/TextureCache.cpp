@@ -0,0 +1,98 @@
+#include "TextureCache.h"
+#include <filesystem>
+#include "Texture.h"
+#include "FileLocator.h"
+
+using namespace glt;
+
+//***********************************************************************************************
+//FUNCTION: must be called on the thread owning the GL context
+std::shared_ptr<CTexture2D> CTextureCache::loadTexture2D(const std::string& vFilePath, GLint vWrapMode, GLint vFilterMode, bool vFlipVertically, bool vIsAsync)
+{
+	std::string FilePath = __getCanonicalPath(vFilePath);
+	std::string Key = format("2D|%s|%d|%d|%d", FilePath.c_str(), vWrapMode, vFilterMode, vFlipVertically);
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	if (auto pTexture = std::static_pointer_cast<CTexture2D>(__findTexture(Key))) return pTexture;
+
+	auto pTexture = std::make_shared<CTexture2D>();
+	if (vIsAsync) pTexture->loadAsync(FilePath.c_str(), vWrapMode, vFilterMode, vFlipVertically);
+	else pTexture->load(FilePath.c_str(), vWrapMode, vFilterMode, vFlipVertically);
+
+	m_CacheEntries[Key] = SCacheEntry{ pTexture, 0 };
+	return pTexture;
+}
+
+//***********************************************************************************************
+//FUNCTION: must be called on the thread owning the GL context
+std::shared_ptr<CTextureCube> CTextureCache::loadTextureCube(const std::vector<std::string>& vFaces, bool vGenerateMipMap)
+{
+	std::vector<std::string> Faces;
+	std::string Key = "Cube";
+	for (const auto& Face : vFaces)
+	{
+		Faces.push_back(__getCanonicalPath(Face));
+		Key += "|" + Faces.back();
+	}
+	Key += vGenerateMipMap ? "|1" : "|0";
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	if (auto pTexture = std::static_pointer_cast<CTextureCube>(__findTexture(Key))) return pTexture;
+
+	auto pTexture = std::make_shared<CTextureCube>();
+	pTexture->load(Faces, vGenerateMipMap);
+
+	m_CacheEntries[Key] = SCacheEntry{ pTexture, 0 };
+	return pTexture;
+}
+
+//***********************************************************************************************
+//FUNCTION: the saved memory only counts the textures which are still alive
+STextureCacheStatistics CTextureCache::getStatistics() const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+
+	STextureCacheStatistics Statistics;
+	Statistics.NumRequests = m_NumRequests;
+	Statistics.NumHits = m_NumHits;
+	for (const auto& Pair : m_CacheEntries)
+	{
+		auto pTexture = Pair.second.pTexture.lock();
+		if (!pTexture) continue;
+
+		Statistics.NumCachedTextures++;
+		Statistics.CachedMemorySize += pTexture->getMemorySize();
+		Statistics.SavedMemorySize += Pair.second.NumHits * pTexture->getMemorySize();
+	}
+
+	return Statistics;
+}
+
+//***********************************************************************************************
+//FUNCTION: the caller has to hold m_Mutex
+std::shared_ptr<CTexture> CTextureCache::__findTexture(const std::string& vKey)
+{
+	m_NumRequests++;
+
+	auto iter = m_CacheEntries.find(vKey);
+	if (iter == m_CacheEntries.end()) return nullptr;
+
+	auto pTexture = iter->second.pTexture.lock();
+	if (!pTexture) { m_CacheEntries.erase(iter); return nullptr; }
+
+	iter->second.NumHits++;
+	m_NumHits++;
+	return pTexture;
+}
+
+//***********************************************************************************************
+//FUNCTION: different relative spellings of the same file end up with the same key
+std::string CTextureCache::__getCanonicalPath(const std::string& vFilePath)
+{
+	std::string FilePath = CFileLocator::getInstance()->locateFile(vFilePath);
+	if (FilePath.empty()) return vFilePath;
+
+	std::error_code ErrorCode;
+	std::filesystem::path CanonicalPath = std::filesystem::weakly_canonical(FilePath, ErrorCode);
+	return ErrorCode ? FilePath : CanonicalPath.generic_string();
+}
\ No newline at end of file
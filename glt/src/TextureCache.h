@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <GLAD/glad.h>
+#include "Common.h"
+#include "Export.h"
+
+namespace glt
+{
+	class CTexture;
+	class CTexture2D;
+	class CTextureCube;
+
+	struct STextureCacheStatistics
+	{
+		unsigned NumRequests = 0;
+		unsigned NumHits = 0;
+		unsigned NumCachedTextures = 0;
+		size_t CachedMemorySize = 0;
+		size_t SavedMemorySize = 0;
+
+		float getHitRate() const { return NumRequests ? static_cast<float>(NumHits) / NumRequests : 0.0f; }
+	};
+
+	//NOTE: the textures are keyed by their canonical path and sampling parameters. The cache only keeps weak references,
+	//      so a texture is released as soon as nobody uses it and is decoded again on the next request
+	class GLT_DECLSPEC CTextureCache
+	{
+	public:
+		_SINGLETON(CTextureCache);
+
+		std::shared_ptr<CTexture2D> loadTexture2D(const std::string& vFilePath, GLint vWrapMode = GL_CLAMP_TO_BORDER, GLint vFilterMode = GL_LINEAR, bool vFlipVertically = false, bool vIsAsync = false);
+		std::shared_ptr<CTextureCube> loadTextureCube(const std::vector<std::string>& vFaces, bool vGenerateMipMap);
+
+		STextureCacheStatistics getStatistics() const;
+
+	private:
+		CTextureCache() = default;
+
+		struct SCacheEntry
+		{
+			std::weak_ptr<CTexture> pTexture;
+			unsigned NumHits = 0;
+		};
+
+		std::shared_ptr<CTexture> __findTexture(const std::string& vKey);
+
+		static std::string __getCanonicalPath(const std::string& vFilePath);
+
+		std::unordered_map<std::string, SCacheEntry> m_CacheEntries;
+		unsigned m_NumRequests = 0;
+		unsigned m_NumHits = 0;
+		mutable std::mutex m_Mutex;
+	};
+}
\ No newline at end of file
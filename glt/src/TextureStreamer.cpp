@@ -0,0 +1,198 @@
+#include "TextureStreamer.h"
+#include <cstring>
+#include "stb_image/stb_image.h"
+#include "Texture.h"
+#include "ThreadPool.h"
+#include "CpuTimer.h"
+
+using namespace glt;
+
+//***********************************************************************************************
+//FUNCTION:
+void CTextureStreamer::request(const std::shared_ptr<CTexture2D>& vTexture, bool vFlipVertically)
+{
+	_ASSERTE(vTexture);
+	m_NumPendingRequests++;
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_IsDestroyed = false;
+	}
+
+	std::weak_ptr<CTexture2D> pTexture = vTexture;
+	std::string FilePath = vTexture->getFilePath();
+	CThreadPool::getInstance()->submit([this, pTexture, FilePath, vFlipVertically]()
+	{
+		SDecodedImage Image;
+		Image.pTexture = pTexture;
+
+		stbi_set_flip_vertically_on_load_thread(vFlipVertically);
+		Image.pImageData = stbi_load(FilePath.c_str(), &Image.Width, &Image.Height, &Image.Channels, 0);
+
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		if (m_IsDestroyed)
+		{
+			stbi_image_free(Image.pImageData);
+			m_NumPendingRequests--;
+			return;
+		}
+		m_DecodedImages.push_back(Image);
+	});
+}
+
+//***********************************************************************************************
+//FUNCTION: uploads the decoded images until the per-frame budget is used up, at least one image is uploaded per call
+//          so that a single large texture cannot stall the streaming
+void CTextureStreamer::update()
+{
+	m_UploadedBytesLastFrame = 0;
+	if (isIdle()) return;
+
+	__generatePendingMipmaps();
+
+	CCPUTimer Timer;
+	Timer.start();
+
+	while (true)
+	{
+		SDecodedImage Image;
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			if (m_DecodedImages.empty()) break;
+			Image = m_DecodedImages.front();
+			m_DecodedImages.pop_front();
+		}
+
+		bool IsMipmapPending = __uploadImage(Image);
+		stbi_image_free(Image.pImageData);
+		if (!IsMipmapPending) m_NumPendingRequests--;
+
+		m_UploadedBytesLastFrame += static_cast<size_t>(Image.Width) * Image.Height * Image.Channels;
+		if (m_UploadedBytesLastFrame >= m_MaxBytesPerFrame || Timer.getTimestamp() >= m_MaxTimeInMSPerFrame) break;
+	}
+
+	Timer.stop();
+}
+
+//***********************************************************************************************
+//FUNCTION: the images decoded but not uploaded yet are dropped, so are the images of the requests still being decoded
+void CTextureStreamer::destroy()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_IsDestroyed = true;
+		for (const auto& Image : m_DecodedImages) stbi_image_free(Image.pImageData);
+		m_NumPendingRequests -= static_cast<unsigned>(m_DecodedImages.size());
+		m_DecodedImages.clear();
+	}
+
+	for (const auto& Mipmap : m_PendingMipmaps) glDeleteSync(Mipmap.Fence);
+	m_NumPendingRequests -= static_cast<unsigned>(m_PendingMipmaps.size());
+	m_PendingMipmaps.clear();
+
+	if (!m_PixelUnpackBuffers.empty()) glDeleteBuffers(static_cast<GLsizei>(m_PixelUnpackBuffers.size()), m_PixelUnpackBuffers.data());
+	m_PixelUnpackBuffers.clear();
+	m_PixelUnpackBufferSizes.clear();
+	m_NextPixelUnpackBuffer = 0;
+}
+
+//***********************************************************************************************
+//FUNCTION: the pixels are copied into a pixel unpack buffer so that the transfer to the texture can be done by the driver
+//          asynchronously. Generating the mip chain right away would wait for that transfer, so a texture with mipmaps
+//          samples its base level only until a fence says the transfer is done. Returns whether the mip chain is pending
+bool CTextureStreamer::__uploadImage(const SDecodedImage& vImage)
+{
+	std::shared_ptr<CTexture2D> pTexture = vImage.pTexture.lock();
+	if (!pTexture) return false;
+
+	if (!vImage.pImageData)
+	{
+		_OUTPUT_WARNING(format("Failed to stream texture %s due to failure of stbi_load().", pTexture->getFilePath().c_str()));
+		pTexture->m_Status = ETextureStatus::Failed;
+		return false;
+	}
+
+	size_t ImageSize = static_cast<size_t>(vImage.Width) * vImage.Height * vImage.Channels;
+	GLuint PixelUnpackBuffer = __acquirePixelUnpackBuffer(ImageSize);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PixelUnpackBuffer);
+	void* pMappedData = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ImageSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (pMappedData)
+	{
+		std::memcpy(pMappedData, vImage.pImageData, ImageSize);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	}
+
+	bool IsMipmapPending = false;
+	glBindTexture(GL_TEXTURE_2D, pTexture->getObjectID());
+	if (pMappedData)
+	{
+		pTexture->__uploadImage(nullptr, vImage.Width, vImage.Height, vImage.Channels);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		if (pTexture->hasMipmaps())
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+			m_PendingMipmaps.push_back({ pTexture, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+			IsMipmapPending = true;
+		}
+	}
+	else
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		pTexture->__uploadImage(vImage.pImageData, vImage.Width, vImage.Height, vImage.Channels);
+		if (pTexture->hasMipmaps()) glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	pTexture->m_Status = ETextureStatus::Complete;
+	return IsMipmapPending;
+}
+
+//***********************************************************************************************
+//FUNCTION: generates the mip chains of the textures whose transfer has finished, the others are checked again next frame
+void CTextureStreamer::__generatePendingMipmaps()
+{
+	for (auto Iter = m_PendingMipmaps.begin(); Iter != m_PendingMipmaps.end();)
+	{
+		GLenum Result = glClientWaitSync(Iter->Fence, 0, 0);
+		if (Result != GL_ALREADY_SIGNALED && Result != GL_CONDITION_SATISFIED && Result != GL_WAIT_FAILED) { ++Iter; continue; }
+
+		glDeleteSync(Iter->Fence);
+		std::shared_ptr<CTexture2D> pTexture = Iter->pTexture.lock();
+		if (pTexture)
+		{
+			glBindTexture(GL_TEXTURE_2D, pTexture->getObjectID());
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		Iter = m_PendingMipmaps.erase(Iter);
+		m_NumPendingRequests--;
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION: the buffers are used round-robin, so the one returned has most likely been consumed by the GPU already
+GLuint CTextureStreamer::__acquirePixelUnpackBuffer(size_t vSize)
+{
+	if (m_PixelUnpackBuffers.empty())
+	{
+		m_PixelUnpackBuffers.resize(NUM_PIXEL_UNPACK_BUFFERS);
+		m_PixelUnpackBufferSizes.resize(NUM_PIXEL_UNPACK_BUFFERS, 0);
+		glGenBuffers(NUM_PIXEL_UNPACK_BUFFERS, m_PixelUnpackBuffers.data());
+	}
+
+	unsigned Index = m_NextPixelUnpackBuffer;
+	m_NextPixelUnpackBuffer = (m_NextPixelUnpackBuffer + 1) % NUM_PIXEL_UNPACK_BUFFERS;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PixelUnpackBuffers[Index]);
+	if (m_PixelUnpackBufferSizes[Index] < vSize)
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, vSize, nullptr, GL_STREAM_DRAW);
+		m_PixelUnpackBufferSizes[Index] = vSize;
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	return m_PixelUnpackBuffers[Index];
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include <memory>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <glad/glad.h>
+#include "Common.h"
+#include "Export.h"
+
+namespace glt
+{
+	class CTexture2D;
+
+	class GLT_DECLSPEC CTextureStreamer
+	{
+	public:
+		~CTextureStreamer() = default;
+		_SINGLETON(CTextureStreamer);
+
+		void request(const std::shared_ptr<CTexture2D>& vTexture, bool vFlipVertically);
+		void update();
+		void destroy();
+
+		void setUploadBudget(size_t vMaxBytesPerFrame, double vMaxTimeInMSPerFrame) { m_MaxBytesPerFrame = vMaxBytesPerFrame; m_MaxTimeInMSPerFrame = vMaxTimeInMSPerFrame; }
+
+		bool isIdle() const { return m_NumPendingRequests == 0; }
+		unsigned getNumPendingRequests() const { return m_NumPendingRequests; }
+		size_t getUploadedBytesLastFrame() const { return m_UploadedBytesLastFrame; }
+
+	private:
+		CTextureStreamer() = default;
+		_DISALLOW_COPY_AND_ASSIGN(CTextureStreamer);
+
+		struct SDecodedImage
+		{
+			std::weak_ptr<CTexture2D> pTexture;
+			unsigned char* pImageData = nullptr;
+			int Width = 0;
+			int Height = 0;
+			int Channels = 0;
+		};
+
+		struct SPendingMipmap
+		{
+			std::weak_ptr<CTexture2D> pTexture;
+			GLsync Fence = nullptr;
+		};
+
+		bool __uploadImage(const SDecodedImage& vImage);
+		void __generatePendingMipmaps();
+		GLuint __acquirePixelUnpackBuffer(size_t vSize);
+
+		//NOTE: an image decoded after destroy is freed by the decoding thread instead of being queued
+		std::deque<SDecodedImage> m_DecodedImages;
+		std::mutex m_Mutex;
+		bool m_IsDestroyed = false;
+		std::atomic<unsigned> m_NumPendingRequests = 0;
+
+		//NOTE: the textures streamed through a pixel unpack buffer whose mip chain waits for the transfer, they count as
+		//      pending requests until it is generated
+		std::deque<SPendingMipmap> m_PendingMipmaps;
+
+		static const unsigned NUM_PIXEL_UNPACK_BUFFERS = 4;
+		std::vector<GLuint> m_PixelUnpackBuffers;
+		std::vector<size_t> m_PixelUnpackBufferSizes;
+		unsigned m_NextPixelUnpackBuffer = 0;
+
+		size_t m_MaxBytesPerFrame = 16 * 1024 * 1024;
+		double m_MaxTimeInMSPerFrame = 2.0;
+		size_t m_UploadedBytesLastFrame = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace glt;
+
+//***********************************************************************************************
+//FUNCTION: one core is left to the render thread which owns the GL context
+CThreadPool::CThreadPool()
+{
+	unsigned NumThreads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	for (unsigned i = 0; i < NumThreads; ++i)
+		m_Workers.emplace_back(&CThreadPool::__workerLoop, this);
+}
+
+//***********************************************************************************************
+//FUNCTION:
+CThreadPool::~CThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_IsStopped = true;
+	}
+	m_Condition.notify_all();
+
+	for (auto& Worker : m_Workers)
+	{
+		if (Worker.joinable()) Worker.join();
+	}
+}
+
+//***********************************************************************************************
+//FUNCTION:
+void CThreadPool::__workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> Task;
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_Condition.wait(Lock, [this]() { return m_IsStopped || !m_Tasks.empty(); });
+			if (m_IsStopped && m_Tasks.empty()) return;
+
+			Task = std::move(m_Tasks.front());
+			m_Tasks.pop();
+		}
+		Task();
+	}
+}
\ No newline at end of file
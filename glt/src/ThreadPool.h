@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include "Common.h"
+#include "Export.h"
+
+namespace glt
+{
+	class GLT_DECLSPEC CThreadPool
+	{
+	public:
+		~CThreadPool();
+		_SINGLETON(CThreadPool);
+
+		template <typename TTask>
+		auto submit(TTask&& vTask) -> std::future<std::invoke_result_t<std::decay_t<TTask>>>
+		{
+			using ResultType = std::invoke_result_t<std::decay_t<TTask>>;
+
+			auto pTask = std::make_shared<std::packaged_task<ResultType()>>(std::forward<TTask>(vTask));
+			std::future<ResultType> Result = pTask->get_future();
+			{
+				std::lock_guard<std::mutex> Lock(m_Mutex);
+				m_Tasks.emplace([pTask]() { (*pTask)(); });
+			}
+			m_Condition.notify_one();
+
+			return Result;
+		}
+
+		size_t getNumThreads() const { return m_Workers.size(); }
+
+	private:
+		CThreadPool();
+		_DISALLOW_COPY_AND_ASSIGN(CThreadPool);
+
+		void __workerLoop();
+
+		std::vector<std::thread> m_Workers;
+		std::queue<std::function<void()>> m_Tasks;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_IsStopped = false;
+	};
+}
\ No newline at end of file
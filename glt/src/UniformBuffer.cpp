@@ -0,0 +1,39 @@
+#include "UniformBuffer.h"
+#include <glad/glad.h>
+#include "Common.h"
+
+using namespace glt;
+
+//********************************************************************
+//FUNCTION:
+CUniformBuffer::CUniformBuffer(unsigned int vSize, unsigned int vBindPoint) : m_Size(vSize), m_BindPoint(vBindPoint)
+{
+	glGenBuffers(1, &m_ObjectID);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_ObjectID);
+	glBufferData(GL_UNIFORM_BUFFER, vSize, nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+//********************************************************************
+//FUNCTION:
+CUniformBuffer::~CUniformBuffer()
+{
+	glDeleteBuffers(1, &m_ObjectID);
+}
+
+//********************************************************************
+//FUNCTION:
+void CUniformBuffer::update(const void* vData, unsigned int vSize, unsigned int vOffset) const
+{
+	_ASSERTE(vOffset + vSize <= m_Size);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_ObjectID);
+	glBufferSubData(GL_UNIFORM_BUFFER, vOffset, vSize, vData);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+//********************************************************************
+//FUNCTION:
+void CUniformBuffer::bindBase() const
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, m_BindPoint, m_ObjectID);
+}
\ No newline at end of file
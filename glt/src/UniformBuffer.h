@@ -0,0 +1,23 @@
+#pragma once
+#include "Export.h"
+
+namespace glt
+{
+	class GLT_DECLSPEC CUniformBuffer
+	{
+	public:
+		CUniformBuffer(unsigned int vSize, unsigned int vBindPoint);
+		~CUniformBuffer();
+
+		void update(const void* vData, unsigned int vSize, unsigned int vOffset = 0) const;
+		void bindBase() const;
+
+		unsigned int getSize() const { return m_Size; }
+		unsigned int getBindPoint() const { return m_BindPoint; }
+
+	private:
+		unsigned int m_ObjectID = 0;
+		unsigned int m_Size = 0;
+		unsigned int m_BindPoint = 0;
+	};
+}
\ No newline at end of file
@@ -19,24 +19,24 @@ CVertexArray::~CVertexArray()
 
 //*********************************************************************
 //FUNCTION:
-void CVertexArray::addBuffer(const CVertexBuffer& vBuffer, const CVertexArrayLayout& vLayout)
+void CVertexArray::addBuffer(const CVertexBuffer& vBuffer, const CVertexArrayLayout& vLayout, unsigned int vFirstAttribute)
 {
+	bind();
 	vBuffer.bind();
 
 	unsigned int Offset = 0;
 	for (auto i = 0u; i < vLayout.getNumElements(); ++i)
 	{
 		auto& Element = vLayout.getElementAt(i);
-		glEnableVertexAttribArray(i);
+		unsigned int Location = vFirstAttribute + i;
+		glEnableVertexAttribArray(Location);
 
-		if (Element.Type == GL_INT || Element.Type == GL_UNSIGNED_INT)
-			glVertexAttribIPointer(i, Element.Count, Element.Type, vLayout.getStride(), (void*)Offset);
-		else if (Element.Type == GL_FLOAT)
-			glVertexAttribPointer(i, Element.Count, Element.Type, Element.Normalized, vLayout.getStride(), (void*)Offset);
+		if (Element.IsInteger)
+			glVertexAttribIPointer(Location, Element.Count, Element.Type, vLayout.getStride(), (void*)Offset);
 		else
-			_ASSERTE(false);
+			glVertexAttribPointer(Location, Element.Count, Element.Type, Element.Normalized, vLayout.getStride(), (void*)Offset);
 
-		Offset += Element.Count * SVertexArrayElement::getSizeOfType(Element.Type);
+		Offset += Element.getSize();
 	}
 }
 
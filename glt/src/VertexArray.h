@@ -11,10 +11,12 @@ namespace glt
 		CVertexArray();
 		~CVertexArray();
 
-		void addBuffer(const CVertexBuffer& vBuffer, const CVertexArrayLayout& vLayout);
+		void addBuffer(const CVertexBuffer& vBuffer, const CVertexArrayLayout& vLayout, unsigned int vFirstAttribute = 0);
 		void bind() const;
 		void unbind() const;
 
+		unsigned int getObjectID() const { return m_ObjectID; }
+
 	private:
 		unsigned int m_ObjectID = 0;
 	};
@@ -10,15 +10,25 @@ namespace glt
 		unsigned int Type;
 		unsigned int Count;
 		bool Normalized;
+		bool IsInteger = false;
+
+		//NOTE: the packed types hold all four components in a single 32-bit word
+		unsigned int getSize() const { return isPackedType(Type) ? sizeof(GLuint) : Count * getSizeOfType(Type); }
+
+		static bool isPackedType(unsigned int vType) { return vType == GL_INT_2_10_10_10_REV || vType == GL_UNSIGNED_INT_2_10_10_10_REV; }
 
 		static unsigned int getSizeOfType(unsigned int vType)
 		{
 			switch (vType)
 			{
 			case GL_FLOAT: return sizeof(GLfloat);
+			case GL_HALF_FLOAT: return sizeof(GLhalf);
 			case GL_UNSIGNED_INT: return sizeof(GLuint);
 			case GL_INT: return sizeof(GLint);
+			case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+			case GL_SHORT: return sizeof(GLshort);
 			case GL_UNSIGNED_BYTE: return sizeof(GLubyte);
+			case GL_BYTE: return sizeof(GLbyte);
 			default: _ASSERTE(false);
 			}
 			return 0;
@@ -47,17 +57,28 @@ namespace glt
 		template<>
 		void push<unsigned int>(unsigned int vCount)
 		{
-			m_VertexArrayElements.push_back({ GL_UNSIGNED_INT, vCount, false });
+			m_VertexArrayElements.push_back({ GL_UNSIGNED_INT, vCount, false, true });
 			m_Stride += vCount * SVertexArrayElement::getSizeOfType(GL_UNSIGNED_INT);
 		}
 
 		template<>
 		void push<int>(unsigned int vCount)
 		{
-			m_VertexArrayElements.push_back({GL_INT, vCount, false});
+			m_VertexArrayElements.push_back({GL_INT, vCount, false, true});
 			m_Stride += vCount * SVertexArrayElement::getSizeOfType(GL_INT);
 		}
 
+		//NOTE: half floats and the (un)signed normalized or packed 2_10_10_10 types are read as floats by the shader,
+		//      vIsInteger keeps integer types such as GL_UNSIGNED_BYTE bone indices as integers
+		void push(unsigned int vType, unsigned int vCount, bool vNormalized, bool vIsInteger = false)
+		{
+			_ASSERTE(!SVertexArrayElement::isPackedType(vType) || vCount == 4);
+			_ASSERTE(!(vNormalized && vIsInteger));
+			SVertexArrayElement Element = { vType, vCount, vNormalized, vIsInteger };
+			m_VertexArrayElements.push_back(Element);
+			m_Stride += Element.getSize();
+		}
+
 		unsigned int getStride() const { return m_Stride; }
 		unsigned int getNumElements() const { return m_VertexArrayElements.size(); }
 		const SVertexArrayElement& getElementAt(unsigned int vIndex) const { _ASSERT(vIndex < m_VertexArrayElements.size()); return m_VertexArrayElements[vIndex]; }
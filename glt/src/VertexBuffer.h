@@ -13,6 +13,8 @@ namespace glt
 		void bind() const;
 		void unbind() const;
 
+		unsigned int getObjectID() const { return m_BufferID; }
+
 	private:
 		unsigned int m_BufferID = 0;
 	};
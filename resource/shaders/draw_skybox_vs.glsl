@@ -4,8 +4,7 @@ layout(location = 0) in vec3 _inPosition;
 
 layout(location = 0) out vec3 _outTexCoords;
 
-uniform mat4 uProjectionMatrix;
-uniform mat4 uViewMatrix;
+#include "frame_uniforms.glsl"
 
 void main()
 {
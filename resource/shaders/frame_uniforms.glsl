@@ -0,0 +1,18 @@
+#ifndef FRAME_UNIFORMS_GLSL
+#define FRAME_UNIFORMS_GLSL
+
+//NOTE: written by CRenderer once per frame, must match SFrameUniforms in Renderer.cpp
+layout(std140, binding = 0) uniform FrameUniforms
+{
+	mat4	uViewMatrix;
+	mat4	uProjectionMatrix;
+	mat4	uViewProjectionMatrix;
+	mat4	uInverseViewMatrix;
+	mat4	uInverseProjectionMatrix;
+	vec3	uViewPos;
+	float	uTime;
+	float	uNearPlane;
+	float	uFarPlane;
+};
+
+#endif
\ No newline at end of file
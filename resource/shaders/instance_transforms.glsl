@@ -0,0 +1,17 @@
+#ifndef INSTANCE_TRANSFORMS_GLSL
+#define INSTANCE_TRANSFORMS_GLSL
+
+//NOTE: an instanced draw of CRenderer reads the model matrix of every instance from the frame's instance transforms,
+//      starting at uInstanceOffset. Other draws leave uInstanceOffset negative and set uModelMatrix. Must match
+//      INSTANCE_TRANSFORM_BINDING in Renderer.cpp
+layout(std430, binding = 15) readonly buffer InstanceTransforms { mat4 uInstanceTransforms[]; };
+uniform mat4 uModelMatrix;
+uniform int uInstanceOffset = -1;
+
+mat4 fetchModelMatrix()
+{
+	if (uInstanceOffset < 0) return uModelMatrix;
+	return uInstanceTransforms[uInstanceOffset + gl_InstanceID];
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#version 460 core
+
+layout(local_size_x = 64) in;
+
+layout(std430, binding = 7) readonly buffer BonePalette { mat4 uBonePalette[]; };
+layout(std430, binding = 8) readonly buffer Positions { uint uPositions[]; };
+layout(std430, binding = 9) readonly buffer ShadingAttributes { uint uShadingAttributes[]; };
+layout(std430, binding = 10) readonly buffer SkinAttributes { uint uSkinAttributes[]; };
+layout(std430, binding = 11) writeonly buffer SkinnedVertices { float uSkinnedVertices[]; };
+
+uniform int uNumVertices;
+uniform int uBoneOffset = 0;
+
+uniform bool uIsVertexPacked = false;
+uniform vec3 uPositionOffset;
+uniform vec3 uPositionScale;
+
+vec4 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return vec4(normalize(n), 0.0);
+}
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uint(uNumVertices)) return;
+
+    vec4 pos, normal, weights;
+    ivec4 boneIDs;
+    if (uIsVertexPacked)
+    {
+        vec2 xy = unpackUnorm2x16(uPositions[2 * i]);
+        vec2 zw = unpackUnorm2x16(uPositions[2 * i + 1]);
+        pos = vec4(uPositionOffset + vec3(xy, zw.x) * uPositionScale, 1.0);
+        normal = decodeOctahedral(unpackSnorm2x16(uShadingAttributes[2 * i]));
+
+        uint ids = uSkinAttributes[2 * i];
+        boneIDs = ivec4(ids & 0xffu, (ids >> 8) & 0xffu, (ids >> 16) & 0xffu, ids >> 24);
+        weights = unpackUnorm4x8(uSkinAttributes[2 * i + 1]);
+    }
+    else
+    {
+        pos = vec4(uintBitsToFloat(uvec3(uPositions[3 * i], uPositions[3 * i + 1], uPositions[3 * i + 2])), 1.0);
+        normal = vec4(uintBitsToFloat(uvec3(uShadingAttributes[5 * i], uShadingAttributes[5 * i + 1], uShadingAttributes[5 * i + 2])), 0.0);
+        boneIDs = ivec4(uSkinAttributes[8 * i], uSkinAttributes[8 * i + 1], uSkinAttributes[8 * i + 2], uSkinAttributes[8 * i + 3]);
+        weights = uintBitsToFloat(uvec4(uSkinAttributes[8 * i + 4], uSkinAttributes[8 * i + 5], uSkinAttributes[8 * i + 6], uSkinAttributes[8 * i + 7]));
+    }
+
+    // vertices without weights, of a mesh without skin merged into a skinned one, stay in the bind pose
+    if (weights != vec4(0.0))
+    {
+        mat4 BoneTransform = uBonePalette[uBoneOffset + boneIDs[0]] * weights[0];
+        BoneTransform += uBonePalette[uBoneOffset + boneIDs[1]] * weights[1];
+        BoneTransform += uBonePalette[uBoneOffset + boneIDs[2]] * weights[2];
+        BoneTransform += uBonePalette[uBoneOffset + boneIDs[3]] * weights[3];
+        pos = BoneTransform * pos;
+        normal = BoneTransform * normal;
+    }
+
+    for (uint k = 0; k < 3; ++k)
+    {
+        uSkinnedVertices[6 * i + k] = pos[k];
+        uSkinnedVertices[6 * i + 3 + k] = normal[k];
+    }
+}
\ No newline at end of file
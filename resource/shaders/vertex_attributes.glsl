@@ -0,0 +1,34 @@
+#ifndef VERTEX_ATTRIBUTES_GLSL
+#define VERTEX_ATTRIBUTES_GLSL
+
+//NOTE: the vertex streams of a CMesh, must match the attribute locations in Mesh.cpp. A mesh loaded with
+//      SModelLoadOptions::PackVertices stores quantized positions and octahedron encoded normals and sets uIsVertexPacked
+//      while it is drawn, so positions and normals are read through fetchVertexPosition and fetchVertexNormal only
+uniform bool uIsVertexPacked = false;
+uniform vec3 uPositionOffset;
+uniform vec3 uPositionScale;
+
+layout(location = 0) in vec3 _inVertexPosition;
+layout(location = 1) in vec3 _inVertexNormal;
+layout(location = 2) in vec2 _inVertexTexCoord;
+layout(location = 3) in ivec4 _inBoneIDs;
+layout(location = 4) in vec4  _inBoneWeights;
+
+vec4 fetchVertexPosition()
+{
+	if (!uIsVertexPacked) return vec4(_inVertexPosition, 1.0);
+	return vec4(uPositionOffset + _inVertexPosition * uPositionScale, 1.0);
+}
+
+vec4 fetchVertexNormal()
+{
+	if (!uIsVertexPacked) return vec4(_inVertexNormal, 0.0);
+
+	vec2 e = _inVertexNormal.xy;
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return vec4(normalize(n), 0.0);
+}
+
+#endif
\ No newline at end of file